@@ -0,0 +1,113 @@
+// Bulk-synchronous rounds: batch_priority_queue against a locked priority_queue.
+//
+//   g++ -std=c++17 -O2 -pthread -Isrc bench/batch_parallel.cpp -o batch_parallel
+//   ./batch_parallel [rounds] [batch] [k] [max_threads]
+//
+// Every round inserts batch random keys and then removes the best k, as a
+// branch-and-bound solver does. The locked baseline lets each thread push
+// and pop its share under one std::mutex; batch_priority_queue uses one
+// shard per thread and the same number of threads through its execution
+// policy. Both remove exactly the same keys, which is checked.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "batch_priority_queue.hpp"
+#include "execution.hpp"
+#include "priority_queue.hpp"
+
+static double elapsed(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+typedef unsigned long long Key;
+
+static std::vector<Key> makeKeys(size_t n) {
+    std::vector<Key> keys(n);
+    Key x = 88172645463325252ull;
+    for (size_t i = 0; i < n; i++) {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        keys[i] = x;
+    }
+    return keys;
+}
+
+// @return sum of the removed keys, to check both variants agree
+static Key lockedRounds(const std::vector<Key> &keys, size_t rounds, size_t batch, size_t k, unsigned threads) {
+    sjtu::priority_queue<Key> pq;
+    std::mutex lock;
+    std::vector<Key> sums(threads, 0);
+    for (size_t r = 0; r < rounds; r++) {
+        const Key *base = keys.data() + r * batch;
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                for (size_t i = batch * t / threads; i < batch * (t + 1) / threads; i++) {
+                    std::lock_guard<std::mutex> guard(lock);
+                    pq.push(base[i]);
+                }
+            });
+        }
+        for (std::thread &w : workers) w.join();
+        workers.clear();
+        for (unsigned t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                for (size_t i = k * t / threads; i < k * (t + 1) / threads; i++) {
+                    std::lock_guard<std::mutex> guard(lock);
+                    if (pq.empty()) break;
+                    sums[t] += pq.top();
+                    pq.pop();
+                }
+            });
+        }
+        for (std::thread &w : workers) w.join();
+    }
+    Key sum = 0;
+    for (Key s : sums) sum += s;
+    return sum;
+}
+
+static Key batchRounds(const std::vector<Key> &keys, size_t rounds, size_t batch, size_t k, unsigned threads) {
+    sjtu::batch_priority_queue<Key> q(threads);
+    sjtu::execution::parallel_policy policy = sjtu::execution::par(threads);
+    std::vector<Key> out(k);
+    Key sum = 0;
+    for (size_t r = 0; r < rounds; r++) {
+        const Key *base = keys.data() + r * batch;
+        q.insert_batch(policy, base, base + batch);
+        auto end = q.delete_top_k(policy, k, out.begin());
+        for (auto it = out.begin(); it != end; ++it) sum += *it;
+    }
+    return sum;
+}
+
+int main(int argc, char *argv[]) {
+    size_t rounds = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100;
+    size_t batch = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000;
+    size_t k = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 50000;
+    unsigned maxThreads = argc > 4 ? std::atoi(argv[4]) : std::thread::hardware_concurrency();
+    if (maxThreads == 0) maxThreads = 1;
+
+    std::vector<Key> keys = makeKeys(rounds * batch);
+    std::printf("%zu rounds of %zu inserts and %zu removals, hardware threads = %u\n",
+                rounds, batch, k, std::thread::hardware_concurrency());
+    std::printf("%-8s %14s %14s %10s\n", "threads", "locked s", "batch s", "speedup");
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        auto start = std::chrono::steady_clock::now();
+        Key lockedSum = lockedRounds(keys, rounds, batch, k, threads);
+        double locked = elapsed(start);
+        start = std::chrono::steady_clock::now();
+        Key batchSum = batchRounds(keys, rounds, batch, k, threads);
+        double batched = elapsed(start);
+        std::printf("%-8u %14.3f %14.3f %9.2fx\n", threads, locked, batched, locked / batched);
+        if (lockedSum != batchSum) {
+            std::printf("the two queues removed different keys\n");
+            return 1;
+        }
+    }
+    return 0;
+}
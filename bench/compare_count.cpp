@@ -0,0 +1,100 @@
+// Comparator calls per operation: leftist priority_queue vs weak_heap.
+//
+//   g++ -std=c++17 -O2 -Isrc bench/compare_count.cpp -o compare_count
+//   ./compare_count [n ...]
+//
+// For each n it reports compares per element for build (n pushes for the
+// leftist heap, the linear constructor for the weak heap), per push, and per
+// pop while draining, together with the wall time using a deliberately
+// expensive comparator on strings.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "priority_queue.hpp"
+#include "weak_heap.hpp"
+
+static long long compares = 0;
+
+struct CountingCompare {
+    bool operator()(const std::string &a, const std::string &b) const {
+        ++compares;
+        return a < b;
+    }
+};
+
+struct Result {
+    double buildCompares;
+    double pushCompares;
+    double popCompares;
+    double seconds;
+};
+
+static double elapsed(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+template<class Heap>
+static void drain(Heap &h, Result &res, size_t n) {
+    compares = 0;
+    while (!h.empty()) h.pop();
+    res.popCompares = (double)compares / n;
+}
+
+static Result runLeftist(const std::vector<std::string> &keys) {
+    Result res;
+    auto start = std::chrono::steady_clock::now();
+    sjtu::priority_queue<std::string, CountingCompare> pq;
+    compares = 0;
+    for (const std::string &k : keys) pq.push(k);
+    res.buildCompares = res.pushCompares = (double)compares / keys.size();
+    drain(pq, res, keys.size());
+    res.seconds = elapsed(start);
+    return res;
+}
+
+static Result runWeak(const std::vector<std::string> &keys) {
+    Result res;
+    auto start = std::chrono::steady_clock::now();
+    compares = 0;
+    sjtu::weak_heap<std::string, CountingCompare> built(keys.begin(), keys.end());
+    res.buildCompares = (double)compares / keys.size();
+    drain(built, res, keys.size());
+    res.seconds = elapsed(start);
+
+    sjtu::weak_heap<std::string, CountingCompare> pushed;
+    compares = 0;
+    for (const std::string &k : keys) pushed.push(k);
+    res.pushCompares = (double)compares / keys.size();
+    return res;
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; i++) sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    if (sizes.empty()) sizes = {1000, 100000, 1000000};
+
+    std::printf("%10s %-8s %10s %10s %10s %10s %10s\n",
+                "n", "engine", "build/el", "push/el", "pop/el", "log2 n", "seconds");
+    for (size_t n : sizes) {
+        // Keys share a long prefix so every comparison walks most of it.
+        std::vector<std::string> keys;
+        keys.reserve(n);
+        unsigned long long x = 88172645463325252ull;
+        for (size_t i = 0; i < n; i++) {
+            x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+            keys.push_back(std::string(48, 'k') + std::to_string(x));
+        }
+        Result leftist = runLeftist(keys), weak = runWeak(keys);
+        double lg = std::log2((double)n);
+        std::printf("%10zu %-8s %10.2f %10.2f %10.2f %10.2f %10.3f\n",
+                    n, "leftist", leftist.buildCompares, leftist.pushCompares, leftist.popCompares, lg, leftist.seconds);
+        std::printf("%10zu %-8s %10.2f %10.2f %10.2f %10.2f %10.3f\n",
+                    n, "weak", weak.buildCompares, weak.pushCompares, weak.popCompares, lg, weak.seconds);
+    }
+    return 0;
+}
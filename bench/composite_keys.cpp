@@ -0,0 +1,90 @@
+// Composite keys: a tuple comparator against keys packed by key_encoder.
+//
+//   g++ -std=c++17 -O2 -Isrc bench/composite_keys.cpp -o composite_keys
+//   ./composite_keys [n]
+//
+// Jobs are ordered by earliest deadline, then higher class, then FIFO. The
+// first queue holds the three fields and compares them one by one; the second
+// holds edf::encode(deadline, cls, seq) as one uint64_t, which also lets
+// compressed_priority_queue store it. All queues must drain in the same order.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <tuple>
+#include <vector>
+
+#include "compressed_priority_queue.hpp"
+#include "key_encoder.hpp"
+#include "priority_queue.hpp"
+
+static double elapsed(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+typedef sjtu::key_encoder<sjtu::key_field<uint32_t, 32, sjtu::key_order::descending>,
+                          sjtu::key_field<uint8_t, 4>,
+                          sjtu::key_field<uint32_t, 28, sjtu::key_order::descending>> edf;
+
+struct Job {
+    uint32_t deadline;
+    uint8_t cls;
+    uint32_t seq;
+};
+
+struct JobCompare {
+    bool operator()(const Job &a, const Job &b) const {
+        if (a.deadline != b.deadline) return a.deadline > b.deadline;
+        if (a.cls != b.cls) return a.cls < b.cls;
+        return a.seq > b.seq;
+    }
+};
+
+template<class Queue, class Push, class Seq>
+static double drain(Queue &q, const std::vector<Job> &jobs, Push push, Seq seqOf, uint64_t &checksum) {
+    auto start = std::chrono::steady_clock::now();
+    for (const Job &j : jobs) push(q, j);
+    checksum = 0;
+    for (uint64_t i = 1; !q.empty(); i++) {
+        checksum += i * seqOf(q.top());
+        q.pop();
+    }
+    return elapsed(start);
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    std::vector<Job> jobs(n);
+    uint64_t x = 88172645463325252ull;
+    for (size_t i = 0; i < n; i++) {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        jobs[i] = Job{(uint32_t)(x % 10000), (uint8_t)(x >> 32 & 15), (uint32_t)i};
+    }
+
+    uint64_t tupleSum, packedSum, compressedSum;
+    sjtu::priority_queue<Job, JobCompare> tupleQueue;
+    double tuple = drain(tupleQueue, jobs,
+                         [](decltype(tupleQueue) &q, const Job &j) { q.push(j); },
+                         [](const Job &j) { return j.seq; }, tupleSum);
+
+    sjtu::priority_queue<uint64_t> packedQueue;
+    double packed = drain(packedQueue, jobs,
+                          [](decltype(packedQueue) &q, const Job &j) { q.push(edf::encode(j.deadline, j.cls, j.seq)); },
+                          [](uint64_t k) { return edf::get<2>(k); }, packedSum);
+
+    sjtu::compressed_priority_queue<uint64_t> compressedQueue;
+    double compressed = drain(compressedQueue, jobs,
+                              [](decltype(compressedQueue) &q, const Job &j) { q.push(edf::encode(j.deadline, j.cls, j.seq)); },
+                              [](uint64_t k) { return edf::get<2>(k); }, compressedSum);
+
+    std::printf("%zu jobs, push all then pop all\n", n);
+    std::printf("%-28s %10.3f s\n", "tuple comparator", tuple);
+    std::printf("%-28s %10.3f s\n", "packed uint64_t", packed);
+    std::printf("%-28s %10.3f s\n", "packed, compressed queue", compressed);
+    if (tupleSum != packedSum || tupleSum != compressedSum) {
+        std::printf("the queues drained in different orders\n");
+        return 1;
+    }
+    return 0;
+}
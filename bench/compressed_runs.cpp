@@ -0,0 +1,72 @@
+// Memory and pop cost of compressed_priority_queue against priority_queue.
+//
+//   g++ -std=c++17 -O2 -Isrc bench/compressed_runs.cpp -o compressed_runs
+//   ./compressed_runs [n] [key_bits]
+//
+// Pushes n random keys below 2^key_bits into both queues, then drains them.
+// Memory for priority_queue is n nodes of 32 bytes (key, two children and
+// dist, allocator overhead not counted); for compressed_priority_queue it is
+// cold_bytes() plus the same 32 bytes for each key still in the hot buffer.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "priority_queue.hpp"
+#include "compressed_priority_queue.hpp"
+
+static double elapsed(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    int bits = argc > 2 ? std::atoi(argv[2]) : 64;
+    unsigned long long mask = bits >= 64 ? ~0ull : (1ull << bits) - 1;
+
+    std::vector<unsigned long long> keys(n);
+    unsigned long long x = 88172645463325252ull;
+    for (size_t i = 0; i < n; i++) {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        keys[i] = x & mask;
+    }
+
+    std::printf("n = %zu, key bits = %d\n", n, bits);
+    unsigned long long check = 0;
+    {
+        auto start = std::chrono::steady_clock::now();
+        sjtu::priority_queue<unsigned long long> pq;
+        for (unsigned long long k : keys) pq.push(k);
+        double push = elapsed(start);
+        start = std::chrono::steady_clock::now();
+        while (!pq.empty()) {
+            check += pq.top();
+            pq.pop();
+        }
+        double pop = elapsed(start);
+        std::printf("%-24s %10.1f MB   push %.3f s   pop %.3f s\n", "priority_queue",
+                    n * 32.0 / 1e6, push, pop);
+    }
+    {
+        auto start = std::chrono::steady_clock::now();
+        sjtu::compressed_priority_queue<unsigned long long> pq;
+        for (unsigned long long k : keys) pq.push(k);
+        double push = elapsed(start);
+        double bytes = pq.cold_bytes() + pq.hot_size() * 32.0;
+        size_t runs = pq.run_count();
+        start = std::chrono::steady_clock::now();
+        while (!pq.empty()) {
+            check -= pq.top();
+            pq.pop();
+        }
+        double pop = elapsed(start);
+        std::printf("%-24s %10.1f MB   push %.3f s   pop %.3f s   (%zu runs, %.2f bytes/key, %.1fx smaller)\n",
+                    "compressed", bytes / 1e6, push, pop, runs, bytes / n, n * 32.0 / bytes);
+    }
+    if (check != 0) {
+        std::printf("mismatch between the two drains\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,442 @@
+// Scalability and stress harness for concurrent front-ends on priority_queue.
+//
+//   g++ -std=c++17 -O2 -pthread -Isrc bench/concurrent_scalability.cpp -o concurrent_scalability
+//   ./concurrent_scalability [threads=N] [ops=200000] [mix=0.5,...] [roles=mixed|split]
+//                            [dist=uniform|ascending|descending|narrow] [prefill=65536] [rank=1]
+//
+// Three front-ends over sjtu::priority_queue are compared at 1, 2, 4, ...
+// threads for every push fraction in mix:
+//  - locked:    one std::mutex around one queue;
+//  - combining: flat combining, where a thread publishes its operation in a
+//               slot and whoever holds the combiner lock applies all of them;
+//  - relaxed:   a MultiQueue of 2 * threads locked queues; push goes to a
+//               random queue, pop takes the better top of two random queues.
+// With roles=mixed every thread pushes with probability mix; with
+// roles=split a mix fraction of the threads only push and the rest only pop.
+//
+// Reported per run: throughput, latency percentiles of single operations,
+// pops that found the queue empty, and the rank error of pops (how many
+// larger keys were present), which must be 0 for the exact front-ends. The
+// rank error comes from replaying a log ordered by tickets drawn inside the
+// critical sections; rank=0 turns the log off for pure throughput. Every run
+// drains the queue at the end and checks that the pushed keys equal the
+// popped ones (count and sum), and exits with status 1 otherwise.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "priority_queue.hpp"
+
+typedef unsigned long long Key;
+
+static std::atomic<unsigned long long> ticketCounter(0);
+static bool logRanks = true;
+
+struct Event {
+    unsigned long long ticket;
+    Key key;
+    bool pop;
+};
+
+// Per-thread log of completed operations, appended inside critical sections.
+struct Log {
+    std::vector<Event> events;
+
+    void record(Key key, bool pop) {
+        if (logRanks) events.push_back(Event{ticketCounter.fetch_add(1, std::memory_order_relaxed), key, pop});
+    }
+};
+
+static inline Key nextRandom(Key &state) {
+    state ^= state << 13, state ^= state >> 7, state ^= state << 17;
+    return state;
+}
+
+class LockedQueue {
+    std::mutex lock;
+    sjtu::priority_queue<Key> pq;
+
+public:
+    explicit LockedQueue(unsigned) {}
+
+    void push(Key key, unsigned, Log &log) {
+        std::lock_guard<std::mutex> guard(lock);
+        pq.push(key);
+        log.record(key, false);
+    }
+
+    bool pop(Key &key, unsigned, Log &log) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (pq.empty()) return false;
+        key = pq.top();
+        pq.pop();
+        log.record(key, true);
+        return true;
+    }
+};
+
+class CombiningQueue {
+    enum { idle, pushing, popping, done };
+
+    struct alignas(64) Slot {
+        std::atomic<int> state{idle};
+        Key key = 0;
+        bool ok = false;
+        Log *log = nullptr;
+    };
+
+    std::atomic_flag combiner = ATOMIC_FLAG_INIT;
+    std::vector<Slot> slots;
+    sjtu::priority_queue<Key> pq;
+
+    void combine() {
+        for (Slot &s : slots) {
+            int op = s.state.load(std::memory_order_acquire);
+            if (op == pushing) {
+                pq.push(s.key);
+                s.log->record(s.key, false);
+            } else if (op == popping) {
+                s.ok = !pq.empty();
+                if (s.ok) {
+                    s.key = pq.top();
+                    pq.pop();
+                    s.log->record(s.key, true);
+                }
+            } else {
+                continue;
+            }
+            s.state.store(done, std::memory_order_release);
+        }
+    }
+
+    void apply(Slot &slot, int op) {
+        slot.state.store(op, std::memory_order_release);
+        while (slot.state.load(std::memory_order_acquire) != done) {
+            if (!combiner.test_and_set(std::memory_order_acquire)) {
+                combine();
+                combiner.clear(std::memory_order_release);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        slot.state.store(idle, std::memory_order_relaxed);
+    }
+
+public:
+    explicit CombiningQueue(unsigned threads) : slots(threads) {}
+
+    void push(Key key, unsigned tid, Log &log) {
+        Slot &slot = slots[tid];
+        slot.key = key;
+        slot.log = &log;
+        apply(slot, pushing);
+    }
+
+    bool pop(Key &key, unsigned tid, Log &log) {
+        Slot &slot = slots[tid];
+        slot.log = &log;
+        apply(slot, popping);
+        key = slot.key;
+        return slot.ok;
+    }
+};
+
+class RelaxedQueue {
+    struct alignas(64) Shard {
+        std::mutex lock;
+        sjtu::priority_queue<Key> pq;
+        std::atomic<Key> top{0};
+        std::atomic<bool> nonEmpty{false};
+
+        void publish() {
+            nonEmpty.store(!pq.empty(), std::memory_order_relaxed);
+            if (!pq.empty()) top.store(pq.top(), std::memory_order_relaxed);
+        }
+    };
+
+    std::vector<Shard> shards;
+    std::vector<Key> rng;
+
+public:
+    explicit RelaxedQueue(unsigned threads) : shards(2 * threads), rng(threads * 8) {
+        for (unsigned t = 0; t < threads; t++) rng[t * 8] = 0x9E3779B97F4A7C15ull * (t + 1);
+    }
+
+    void push(Key key, unsigned tid, Log &log) {
+        Key &state = rng[tid * 8];
+        while (true) {
+            Shard &s = shards[nextRandom(state) % shards.size()];
+            if (!s.lock.try_lock()) continue;
+            s.pq.push(key);
+            s.publish();
+            log.record(key, false);
+            s.lock.unlock();
+            return;
+        }
+    }
+
+    bool pop(Key &key, unsigned tid, Log &log) {
+        Key &state = rng[tid * 8];
+        for (size_t attempt = 0; attempt < 4 * shards.size(); attempt++) {
+            Shard *a = &shards[nextRandom(state) % shards.size()];
+            Shard *b = &shards[nextRandom(state) % shards.size()];
+            bool hasA = a->nonEmpty.load(std::memory_order_relaxed);
+            bool hasB = b->nonEmpty.load(std::memory_order_relaxed);
+            if (!hasA && !hasB) continue;
+            if (!hasA || (hasB && a->top.load(std::memory_order_relaxed) < b->top.load(std::memory_order_relaxed))) a = b;
+            if (!a->lock.try_lock()) continue;
+            bool ok = !a->pq.empty();
+            if (ok) {
+                key = a->pq.top();
+                a->pq.pop();
+                a->publish();
+                log.record(key, true);
+            }
+            a->lock.unlock();
+            if (ok) return true;
+        }
+        // Sampling kept missing: fall back to a full scan before reporting empty.
+        for (Shard &s : shards) {
+            std::lock_guard<std::mutex> guard(s.lock);
+            if (s.pq.empty()) continue;
+            key = s.pq.top();
+            s.pq.pop();
+            s.publish();
+            log.record(key, true);
+            return true;
+        }
+        return false;
+    }
+};
+
+struct Options {
+    unsigned maxThreads = std::thread::hardware_concurrency();
+    size_t ops = 200000;
+    std::vector<double> mixes = {0.5};
+    bool split = false;
+    std::string dist = "uniform";
+    size_t prefill = 65536;
+};
+
+static Key makeKey(const std::string &dist, Key &state, size_t i, unsigned tid, unsigned threads) {
+    if (dist == "ascending") return (Key)i * threads + tid;
+    if (dist == "descending") return ~((Key)i * threads + tid);
+    if (dist == "narrow") return nextRandom(state) % 1024;
+    return nextRandom(state);
+}
+
+struct alignas(64) ThreadResult {
+    std::vector<float> latency;  // ns per operation
+    Log log;
+    size_t pushes = 0, pops = 0, empty = 0;
+    Key pushedSum = 0, poppedSum = 0;
+};
+
+// Fenwick tree over key ranks, for counting present keys above a key.
+class Fenwick {
+    std::vector<long long> tree;
+
+public:
+    explicit Fenwick(size_t n) : tree(n + 1, 0) {}
+
+    void add(size_t i, long long d) {
+        for (++i; i < tree.size(); i += i & -i) tree[i] += d;
+    }
+
+    long long prefix(size_t i) const {  // sum over [0, i)
+        long long s = 0;
+        for (; i > 0; i -= i & -i) s += tree[i];
+        return s;
+    }
+};
+
+static void rankErrors(std::vector<ThreadResult> &results, const std::vector<Key> &prefill, double &mean, long long &worst) {
+    std::vector<Event> events;
+    for (Key k : prefill) events.push_back(Event{0, k, false});
+    for (ThreadResult &r : results) events.insert(events.end(), r.log.events.begin(), r.log.events.end());
+    std::stable_sort(events.begin(), events.end(), [](const Event &a, const Event &b) { return a.ticket < b.ticket; });
+    std::vector<Key> keys;
+    for (const Event &e : events) keys.push_back(e.key);
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    Fenwick present(keys.size());
+    long long total = 0, pops = 0, size = 0;
+    worst = 0;
+    for (const Event &e : events) {
+        size_t rank = std::lower_bound(keys.begin(), keys.end(), e.key) - keys.begin();
+        if (!e.pop) {
+            present.add(rank, 1);
+            ++size;
+            continue;
+        }
+        long long above = size - present.prefix(rank + 1);
+        total += above;
+        worst = std::max(worst, above);
+        ++pops;
+        present.add(rank, -1);
+        --size;
+    }
+    mean = pops ? (double)total / pops : 0;
+}
+
+static double percentile(std::vector<float> &v, double p) {
+    if (v.empty()) return 0;
+    size_t i = std::min(v.size() - 1, (size_t)(p * v.size()));
+    std::nth_element(v.begin(), v.begin() + i, v.end());
+    return v[i];
+}
+
+template<class Queue>
+static bool run(const char *name, const Options &opt, unsigned threads, double mix) {
+    Queue queue(threads);
+    std::vector<Key> prefill(opt.prefill);
+    Key seed = 0x2545F4914F6CDD1Dull;
+    Log prefillLog;
+    Key prefillSum = 0;
+    bool savedLog = logRanks;
+    logRanks = false;
+    for (size_t i = 0; i < prefill.size(); i++) {
+        // Monotone runs start from the opposite end of the prefill, so every
+        // new key lands above (ascending) or below (descending) all of it.
+        if (opt.dist == "ascending") prefill[i] = 0;
+        else if (opt.dist == "descending") prefill[i] = ~0ull;
+        else prefill[i] = makeKey(opt.dist, seed, i, 0, 1);
+        queue.push(prefill[i], 0, prefillLog);
+        prefillSum += prefill[i];
+    }
+    logRanks = savedLog;
+    ticketCounter.store(1);
+
+    std::vector<ThreadResult> results(threads);
+    std::atomic<unsigned> ready(0);
+    std::atomic<bool> go(false);
+    auto worker = [&](unsigned tid) {
+        ThreadResult &r = results[tid];
+        r.latency.reserve(opt.ops);
+        if (logRanks) r.log.events.reserve(opt.ops);
+        Key state = 0x9E3779B97F4A7C15ull * (tid + 7);
+        unsigned producers = (unsigned)(mix * threads + 0.5);
+        if (producers == 0) producers = 1;
+        if (producers >= threads && threads > 1) producers = threads - 1;
+        bool producer = tid < producers;
+        ready.fetch_add(1);
+        while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+        for (size_t i = 0; i < opt.ops; i++) {
+            bool doPush = opt.split && threads > 1 ? producer : (double)(nextRandom(state) >> 11) / (1ull << 53) < mix;
+            auto start = std::chrono::steady_clock::now();
+            if (doPush) {
+                Key key = makeKey(opt.dist, state, i, tid, threads);
+                queue.push(key, tid, r.log);
+                ++r.pushes;
+                r.pushedSum += key;
+            } else {
+                Key key;
+                if (queue.pop(key, tid, r.log)) {
+                    ++r.pops;
+                    r.poppedSum += key;
+                } else {
+                    ++r.empty;
+                }
+            }
+            r.latency.push_back(std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - start).count());
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; t++) pool.emplace_back(worker, t);
+    while (ready.load() < threads) std::this_thread::yield();
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread &t : pool) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Conservation: prefill + pushed == popped + drained.
+    size_t pushes = prefill.size(), pops = 0, empty = 0;
+    Key pushedSum = prefillSum, poppedSum = 0;
+    std::vector<float> latency;
+    for (ThreadResult &r : results) {
+        pushes += r.pushes;
+        pops += r.pops;
+        empty += r.empty;
+        pushedSum += r.pushedSum;
+        poppedSum += r.poppedSum;
+        latency.insert(latency.end(), r.latency.begin(), r.latency.end());
+    }
+    bool savedDrain = logRanks;
+    logRanks = false;
+    Log drainLog;
+    Key key;
+    while (queue.pop(key, 0, drainLog)) {
+        ++pops;
+        poppedSum += key;
+    }
+    logRanks = savedDrain;
+    bool conserved = pushes == pops && pushedSum == poppedSum;
+
+    double meanRank = 0;
+    long long worstRank = 0;
+    if (logRanks) rankErrors(results, prefill, meanRank, worstRank);
+
+    double total = (double)threads * opt.ops;
+    std::printf("%-10s %3u %5.2f %10.2f %8.0f %8.0f %9.0f %9zu", name, threads, mix, total / seconds / 1e6,
+                percentile(latency, 0.5), percentile(latency, 0.99), percentile(latency, 0.999), empty);
+    if (logRanks) std::printf(" %10.2f %9lld", meanRank, worstRank);
+    else std::printf(" %10s %9s", "-", "-");
+    std::printf("  %s\n", conserved ? "ok" : "LOST");
+    return conserved;
+}
+
+int main(int argc, char *argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; i++) {
+        const char *eq = std::strchr(argv[i], '=');
+        if (!eq) {
+            std::fprintf(stderr, "expected key=value, got %s\n", argv[i]);
+            return 2;
+        }
+        std::string key(argv[i], eq - argv[i]), value(eq + 1);
+        if (key == "threads") opt.maxThreads = std::atoi(value.c_str());
+        else if (key == "ops") opt.ops = std::strtoull(value.c_str(), nullptr, 10);
+        else if (key == "roles") opt.split = value == "split";
+        else if (key == "dist") opt.dist = value;
+        else if (key == "prefill") opt.prefill = std::strtoull(value.c_str(), nullptr, 10);
+        else if (key == "rank") logRanks = value != "0";
+        else if (key == "mix") {
+            opt.mixes.clear();
+            for (size_t p = 0; p < value.size();) {
+                size_t q = value.find(',', p);
+                if (q == std::string::npos) q = value.size();
+                opt.mixes.push_back(std::atof(value.substr(p, q - p).c_str()));
+                p = q + 1;
+            }
+        } else {
+            std::fprintf(stderr, "unknown option %s\n", key.c_str());
+            return 2;
+        }
+    }
+    if (opt.maxThreads == 0) opt.maxThreads = 1;
+
+    std::printf("ops/thread = %zu, roles = %s, dist = %s, prefill = %zu, hardware threads = %u\n",
+                opt.ops, opt.split ? "split" : "mixed", opt.dist.c_str(), opt.prefill,
+                std::thread::hardware_concurrency());
+    std::printf("%-10s %3s %5s %10s %8s %8s %9s %9s %10s %9s  %s\n", "queue", "thr", "push", "Mops/s",
+                "p50 ns", "p99 ns", "p99.9 ns", "empty", "rank mean", "rank max", "conserved");
+    bool ok = true;
+    for (double mix : opt.mixes) {
+        for (unsigned threads = 1; threads <= opt.maxThreads; threads *= 2) {
+            ok &= run<LockedQueue>("locked", opt, threads, mix);
+            ok &= run<CombiningQueue>("combining", opt, threads, mix);
+            ok &= run<RelaxedQueue>("relaxed", opt, threads, mix);
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,236 @@
+// Cost of the strong exception guarantee when Compare throws.
+//
+//   g++ -std=c++17 -O2 -Isrc bench/exception_rollback.cpp -o exception_rollback
+//   ./exception_rollback [n] [rate ...]
+//
+// For the leftist priority_queue and weak_heap, every comparison throws with
+// probability rate (default 0, 1e-6, 1e-4, 1e-2). Each run pushes n / 2 keys,
+// merges n / 2 more in prebuilt chunks and pops all n; a failed operation is
+// retried, and the pops are checked to come out in order, so a broken
+// rollback shows up as an error. An operation that fails maxAttempts times in
+// a row (a large weak_heap::merge at a high rate) is finished with injection
+// suspended and counted as forced. Each operation is timed on its
+// own, split into successful ones and failed ones (the latter include the
+// rollback and the throw), so the time of successful operations at each rate
+// can be compared with the "plain" row, which uses a comparator without the
+// injection hook.
+//
+// The memory needed to roll back is measured separately on untimed
+// operations: stack as the depth below the caller at the deepest comparison
+// (the leftist heap keeps its undo state in the merge recursion, weak_heap
+// in a fixed journal, and both compare at the bottom of it), heap as the
+// peak of bytes allocated during the operation and not yet freed (a new
+// node, or weak_heap::merge's rebuilt copy).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "priority_queue.hpp"
+#include "weak_heap.hpp"
+
+typedef unsigned long long Key;
+
+// Allocation tracking for the heap-memory column.
+static size_t liveBytes = 0, peakBytes = 0;
+
+void *operator new(size_t size) {
+    void *p = std::malloc(size + 16);
+    if (!p) throw std::bad_alloc();
+    *static_cast<size_t *>(p) = size;
+    liveBytes += size;
+    if (liveBytes > peakBytes) peakBytes = liveBytes;
+    return static_cast<char *>(p) + 16;
+}
+
+void operator delete(void *p) noexcept {
+    if (!p) return;
+    char *base = static_cast<char *>(p) - 16;
+    liveBytes -= *reinterpret_cast<size_t *>(base);
+    std::free(base);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    operator delete(p);
+}
+
+// Failure injection: each comparison throws with probability threshold / 2^64.
+static Key threshold = 0;
+static Key rng = 0x9E3779B97F4A7C15ull;
+
+// While tracking, the lowest stack address any comparison ran at.
+static bool tracking = false;
+static uintptr_t lowestFrame = 0;
+
+struct InjectedCompare {
+    bool operator()(Key a, Key b) const {
+        if (tracking) {
+            char here;
+            uintptr_t at = reinterpret_cast<uintptr_t>(&here);
+            if (at < lowestFrame) lowestFrame = at;
+        }
+        if (threshold) {
+            rng ^= rng << 13, rng ^= rng >> 7, rng ^= rng << 17;
+            if (rng < threshold) throw sjtu::runtime_error();
+        }
+        return a < b;
+    }
+};
+
+struct PlainCompare {
+    bool operator()(Key a, Key b) const {
+        return a < b;
+    }
+};
+
+struct OpStats {
+    size_t ok = 0, failed = 0, forced = 0;
+    double okNs = 0, failedNs = 0;
+};
+
+static double nowNs() {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const int maxAttempts = 16;
+
+// Run op until it succeeds, timing every attempt.
+template<class Op>
+static void attempt(OpStats &stats, Op op) {
+    for (int tries = 0;; tries++) {
+        Key saved = threshold;
+        if (tries == maxAttempts) {
+            threshold = 0;
+            ++stats.forced;
+        }
+        double start = nowNs();
+        try {
+            op();
+            stats.okNs += nowNs() - start;
+            ++stats.ok;
+            threshold = saved;
+            return;
+        } catch (const sjtu::runtime_error &) {
+            stats.failedNs += nowNs() - start;
+            ++stats.failed;
+        }
+    }
+}
+
+static void report(const char *name, const char *rate, const char *op, const OpStats &s) {
+    std::printf("%-8s %-8s %-6s %10zu %10.1f %10zu", name, rate, op, s.ok, s.ok ? s.okNs / s.ok : 0.0, s.failed);
+    if (s.failed) std::printf(" %12.1f", s.failedNs / s.failed);
+    if (s.forced) std::printf("   (%zu forced)", s.forced);
+    std::printf("\n");
+}
+
+// rate < 0 labels the run with PlainCompare.
+template<class Heap>
+static bool timedRun(const char *name, double rate, const std::vector<Key> &keys, size_t chunk) {
+    char label[16];
+    if (rate < 0) std::snprintf(label, sizeof(label), "plain");
+    else std::snprintf(label, sizeof(label), "%g", rate);
+    size_t n = keys.size(), half = n / 2;
+    threshold = 0;
+    std::vector<Heap *> chunks;
+    for (size_t i = half; i < n; i += chunk)
+        chunks.push_back(new Heap(keys.begin() + i, keys.begin() + std::min(n, i + chunk)));
+    threshold = rate <= 0 ? 0 : rate >= 1 ? ~0ull : (Key)(rate * 18446744073709551616.0);
+
+    Heap heap;
+    OpStats push, merge, pop;
+    for (size_t i = 0; i < half; i++) attempt(push, [&]() { heap.push(keys[i]); });
+    for (Heap *c : chunks) attempt(merge, [&]() { heap.merge(*c); });
+    bool sorted = heap.size() == n;
+    Key prev = ~0ull;
+    while (!heap.empty()) {
+        Key k = heap.top();
+        sorted = sorted && k <= prev;
+        prev = k;
+        attempt(pop, [&]() { heap.pop(); });
+    }
+    threshold = 0;
+    for (Heap *c : chunks) delete c;
+
+    report(name, label, "push", push);
+    report(name, label, "merge", merge);
+    report(name, label, "pop", pop);
+    if (!sorted) std::printf("%-8s %-8s rollback corrupted the heap\n", name, label);
+    return sorted;
+}
+
+struct MemStats {
+    size_t stack = 0, heap = 0;
+};
+
+template<class Op>
+__attribute__((noinline)) static void measure(MemStats &stats, Op op) {
+    char base;
+    uintptr_t top = reinterpret_cast<uintptr_t>(&base);
+    lowestFrame = top;
+    tracking = true;
+    size_t before = liveBytes;
+    peakBytes = liveBytes;
+    op();
+    tracking = false;
+    stats.heap = std::max(stats.heap, peakBytes - before);
+    stats.stack = std::max(stats.stack, (size_t)(top - lowestFrame));
+}
+
+template<class Heap>
+static void memoryRun(const char *name, const std::vector<Key> &keys) {
+    threshold = 0;
+    Heap heap(keys.begin(), keys.end());
+    MemStats push, merge, pop;
+    for (size_t i = 0; i < 256; i++) {
+        Key k = keys[i * 7919 % keys.size()];
+        measure(push, [&]() { heap.push(k); });
+        measure(pop, [&]() { heap.pop(); });
+    }
+    for (size_t i = 0; i < 4; i++) {
+        Heap other(keys.begin(), keys.begin() + std::min<size_t>(64, keys.size()));
+        measure(merge, [&]() { heap.merge(other); });
+    }
+    std::printf("%-8s %-6s %10zu %12zu\n", name, "push", push.stack, push.heap);
+    std::printf("%-8s %-6s %10zu %12zu\n", name, "merge", merge.stack, merge.heap);
+    std::printf("%-8s %-6s %10zu %12zu\n", name, "pop", pop.stack, pop.heap);
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::vector<double> rates;
+    for (int i = 2; i < argc; i++) rates.push_back(std::atof(argv[i]));
+    if (rates.empty()) rates = {0, 1e-6, 1e-4, 1e-2};
+    if (n < 2) n = 2;
+
+    std::vector<Key> keys(n);
+    Key x = 88172645463325252ull;
+    for (size_t i = 0; i < n; i++) {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        keys[i] = x;
+    }
+
+    double clock = nowNs();
+    for (int i = 0; i < 1000; i++) nowNs();
+    clock = (nowNs() - clock) / 1000;
+    std::printf("n = %zu; per-op times include ~%.0f ns of clock overhead\n\n", n, clock);
+
+    // weak_heap::merge rebuilds both heaps, so it gets few large chunks.
+    size_t weakChunk = std::max<size_t>(1, n / 16);
+    bool ok = true;
+    std::printf("%-8s %-8s %-6s %10s %10s %10s %12s\n", "heap", "rate", "op", "ok", "ok ns", "failed", "rollback ns");
+    ok &= timedRun<sjtu::priority_queue<Key, PlainCompare>>("leftist", -1, keys, 64);
+    for (double rate : rates) ok &= timedRun<sjtu::priority_queue<Key, InjectedCompare>>("leftist", rate, keys, 64);
+    ok &= timedRun<sjtu::weak_heap<Key, PlainCompare>>("weak", -1, keys, weakChunk);
+    for (double rate : rates) ok &= timedRun<sjtu::weak_heap<Key, InjectedCompare>>("weak", rate, keys, weakChunk);
+
+    std::printf("\nrollback state per operation (max over samples, bytes)\n");
+    std::printf("%-8s %-6s %10s %12s\n", "heap", "op", "stack", "heap");
+    memoryRun<sjtu::priority_queue<Key, InjectedCompare>>("leftist", keys);
+    memoryRun<sjtu::weak_heap<Key, InjectedCompare>>("weak", keys);
+    return ok ? 0 : 1;
+}
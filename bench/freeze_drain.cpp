@@ -0,0 +1,91 @@
+// Drain-heavy phases: popping a frozen priority_queue against a live one.
+//
+//   g++ -std=c++17 -O2 -Isrc bench/freeze_drain.cpp -o freeze_drain
+//   ./freeze_drain [n] [push_every]
+//
+// The queue is filled with n random keys and then drained, with one push
+// after every push_every pops (0: none). "live" pops the leftist heap;
+// "frozen" calls freeze() first and includes its cost. Both must pop the
+// same keys, which is checked. Integer keys take the radix path of
+// freeze(); the pair keys go through the comparison sort.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "priority_queue.hpp"
+
+static double elapsed(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+struct Pair {
+    unsigned long long a, b;
+};
+
+struct PairCompare {
+    bool operator()(const Pair &x, const Pair &y) const {
+        return x.a != y.a ? x.a < y.a : x.b < y.b;
+    }
+};
+
+static unsigned long long key(unsigned long long x) {
+    return x;
+}
+
+static unsigned long long key(const Pair &p) {
+    return p.a ^ p.b;
+}
+
+template<class T, class Compare>
+static double drain(const std::vector<T> &keys, size_t pushEvery, bool freeze, unsigned long long &checksum) {
+    sjtu::priority_queue<T, Compare> q(keys.begin(), keys.end());
+    auto start = std::chrono::steady_clock::now();
+    if (freeze) q.freeze();
+    checksum = 0;
+    size_t next = 0;
+    for (size_t pops = 1; !q.empty(); pops++) {
+        checksum = checksum * 31 + key(q.top());
+        q.pop();
+        if (pushEvery && pops % pushEvery == 0 && next < keys.size()) q.push(keys[next++]);
+    }
+    return elapsed(start);
+}
+
+template<class T, class Compare>
+static bool run(const char *name, const std::vector<T> &keys, size_t pushEvery) {
+    unsigned long long liveSum, frozenSum;
+    double live = drain<T, Compare>(keys, pushEvery, false, liveSum);
+    double frozen = drain<T, Compare>(keys, pushEvery, true, frozenSum);
+    std::printf("%-10s %12.3f %12.3f %9.2fx\n", name, live, frozen, live / frozen);
+    return liveSum == frozenSum;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    size_t pushEvery = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000;
+
+    std::vector<unsigned long long> ints(n);
+    std::vector<Pair> pairs(n);
+    unsigned long long x = 88172645463325252ull;
+    for (size_t i = 0; i < n; i++) {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        ints[i] = x;
+        pairs[i] = Pair{x % 1000, x >> 10};
+    }
+
+    if (pushEvery) {
+        std::printf("drain %zu keys, one push every %zu pops\n", n, pushEvery);
+    } else {
+        std::printf("drain %zu keys without pushes\n", n);
+    }
+    std::printf("%-10s %12s %12s %10s\n", "keys", "live s", "frozen s", "speedup");
+    bool same = run<unsigned long long, std::less<unsigned long long>>("integer", ints, pushEvery) &&
+                run<Pair, PairCompare>("pair", pairs, pushEvery);
+    if (!same) {
+        std::printf("the frozen and live queues popped different keys\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+// Bulk construction time of priority_queue against the number of threads.
+//
+//   g++ -std=c++17 -O2 -pthread -Isrc bench/parallel_build.cpp -o parallel_build
+//   ./parallel_build [n] [max_threads]
+//
+// Compares n pushes, the sequential O(n) range constructor and the
+// execution-policy constructor at 1, 2, 4, ... max_threads threads, and
+// prints the speedup of each parallel build over the sequential one.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "priority_queue.hpp"
+#include "execution.hpp"
+
+static double elapsed(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    unsigned maxThreads = argc > 2 ? std::atoi(argv[2]) : std::thread::hardware_concurrency();
+    if (maxThreads == 0) maxThreads = 1;
+
+    std::vector<unsigned long long> keys(n);
+    unsigned long long x = 88172645463325252ull;
+    for (size_t i = 0; i < n; i++) {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        keys[i] = x;
+    }
+
+    std::printf("n = %zu, hardware threads = %u\n", n, std::thread::hardware_concurrency());
+    {
+        auto start = std::chrono::steady_clock::now();
+        sjtu::priority_queue<unsigned long long> pq;
+        for (unsigned long long k : keys) pq.push(k);
+        std::printf("%-24s %8.3f s\n", "push loop", elapsed(start));
+    }
+    double sequential;
+    {
+        auto start = std::chrono::steady_clock::now();
+        sjtu::priority_queue<unsigned long long> pq(keys.begin(), keys.end());
+        sequential = elapsed(start);
+        std::printf("%-24s %8.3f s\n", "range constructor", sequential);
+    }
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        auto start = std::chrono::steady_clock::now();
+        sjtu::priority_queue<unsigned long long> pq(sjtu::execution::par(threads), keys.begin(), keys.end());
+        double t = elapsed(start);
+        char label[32];
+        std::snprintf(label, sizeof(label), "par(%u)", threads);
+        std::printf("%-24s %8.3f s   speedup %.2fx\n", label, t, sequential / t);
+    }
+    return 0;
+}
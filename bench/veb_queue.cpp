@@ -0,0 +1,84 @@
+// 32-bit integer priorities: veb_priority_queue against the leftist
+// priority_queue.
+//
+//   g++ -std=c++17 -O2 -Isrc bench/veb_queue.cpp -o veb_queue
+//   ./veb_queue [n ...]            e.g. ./veb_queue 1000000 10000000 100000000
+//
+// For each n: push n random keys, then n "hold" operations (pop the top,
+// push a fresh random key, so pops are not monotone), then drain. Times are
+// nanoseconds per operation. The leftist queue needs about 32 bytes a node,
+// so it is skipped above 2e7 elements; the veb queue stays near 0.52 GiB
+// (65536 pages of 8456 bytes) plus the repeat table once n passes 1e5. Both must pop the same keys, which is checked.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "priority_queue.hpp"
+#include "veb_priority_queue.hpp"
+
+static double elapsed(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+struct Result {
+    double push, hold, drain;  // ns per operation
+    unsigned long long checksum;
+};
+
+template<class Queue>
+static Result run(size_t n) {
+    uint64_t x = 88172645463325252ull;
+    auto next = [&x]() {
+        x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+        return (uint32_t)(x >> 32);
+    };
+    Result r;
+    r.checksum = 0;
+    Queue q;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; i++) q.push(next());
+    r.push = elapsed(start) * 1e9 / n;
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; i++) {
+        r.checksum = r.checksum * 31 + q.top();
+        q.pop();
+        q.push(next());
+    }
+    r.hold = elapsed(start) * 1e9 / n;
+
+    start = std::chrono::steady_clock::now();
+    while (!q.empty()) {
+        r.checksum = r.checksum * 31 + q.top();
+        q.pop();
+    }
+    r.drain = elapsed(start) * 1e9 / n;
+    return r;
+}
+
+static void print(const char *name, size_t n, const Result &r) {
+    std::printf("%-12zu %-10s %10.1f %10.1f %10.1f\n", n, name, r.push, r.hold, r.drain);
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; i++) sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    if (sizes.empty()) sizes = {1000000, 10000000};
+
+    std::printf("%-12s %-10s %10s %10s %10s\n", "n", "engine", "push ns", "hold ns", "drain ns");
+    for (size_t n : sizes) {
+        Result veb = run<sjtu::veb_priority_queue<uint32_t>>(n);
+        print("veb", n, veb);
+        if (n > 20000000) continue;
+        Result leftist = run<sjtu::priority_queue<uint32_t>>(n);
+        print("leftist", n, leftist);
+        if (veb.checksum != leftist.checksum) {
+            std::printf("the two queues popped different keys\n");
+            return 1;
+        }
+    }
+    return 0;
+}
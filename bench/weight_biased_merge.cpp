@@ -0,0 +1,109 @@
+// Merge-heavy workloads: rank-biased priority_queue vs weight_biased_heap.
+//
+//   g++ -std=c++17 -O2 -Isrc bench/weight_biased_merge.cpp -o weight_biased_merge
+//   ./weight_biased_merge [n] [heaps]
+//
+// "five" is the data/five workload: push n random keys into each of two
+// heaps, merge them and drain the result. "meld" spreads the 2n keys over
+// `heaps` heaps, merges them pairwise in tournament rounds until one is
+// left, then drains it. Both engines must pop the same keys,
+// which is checked; comparisons are counted alongside the wall time.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "priority_queue.hpp"
+#include "weight_biased_heap.hpp"
+
+static long long compares = 0;
+
+struct CountingCompare {
+    bool operator()(int a, int b) const {
+        ++compares;
+        return a < b;
+    }
+};
+
+static double elapsed(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+template<class Heap>
+static unsigned long long drain(Heap &h) {
+    unsigned long long sum = 0;
+    while (!h.empty()) {
+        sum = sum * 31 + (unsigned)h.top();
+        h.pop();
+    }
+    return sum;
+}
+
+template<class Heap>
+static unsigned long long five(const std::vector<int> &keys, size_t n) {
+    Heap a, b;
+    for (size_t i = 0; i < n; i++) a.push(keys[i]);
+    for (size_t i = n; i < 2 * n; i++) b.push(keys[i]);
+    a.merge(b);
+    return drain(a);
+}
+
+template<class Heap>
+static unsigned long long meld(const std::vector<int> &keys, size_t n, size_t heaps) {
+    std::vector<Heap> pool(heaps);
+    for (size_t i = 0; i < n; i++) pool[i % heaps].push(keys[i]);
+    // Tournament rounds: merge neighbours pairwise, then move each winner
+    // down to slot i / 2, which is empty by then (merging into an empty
+    // heap costs no comparisons).
+    for (size_t live = heaps; live > 1; live = (live + 1) / 2) {
+        for (size_t i = 0; i + 1 < live; i += 2) {
+            pool[i].merge(pool[i + 1]);
+            if (i) pool[i / 2].merge(pool[i]);
+        }
+        if (live % 2) pool[live / 2].merge(pool[live - 1]);
+    }
+    return drain(pool[0]);
+}
+
+struct Result {
+    double seconds;
+    double compares;
+    unsigned long long checksum;
+};
+
+template<class Run>
+static Result measure(Run run, size_t elements) {
+    compares = 0;
+    auto start = std::chrono::steady_clock::now();
+    unsigned long long sum = run();
+    return Result{elapsed(start), (double)compares / elements, sum};
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 400000;
+    size_t heaps = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4096;
+    if (heaps == 0) heaps = 1;
+
+    std::vector<int> keys(2 * n);
+    unsigned x = 1727417277u;
+    for (int &k : keys) k = (int)(x += (x << 5) + 172741827u);
+
+    typedef sjtu::priority_queue<int, CountingCompare> rank_heap;
+    typedef sjtu::weight_biased_heap<int, CountingCompare> weight_heap;
+
+    std::printf("%-6s %-14s %10s %14s\n", "work", "engine", "seconds", "compares/elt");
+    Result r1 = measure([&]() { return five<rank_heap>(keys, n); }, 2 * n);
+    Result w1 = measure([&]() { return five<weight_heap>(keys, n); }, 2 * n);
+    std::printf("%-6s %-14s %10.3f %14.2f\n", "five", "dist-based", r1.seconds, r1.compares);
+    std::printf("%-6s %-14s %10.3f %14.2f\n", "five", "weight-biased", w1.seconds, w1.compares);
+    Result r2 = measure([&]() { return meld<rank_heap>(keys, 2 * n, heaps); }, 2 * n);
+    Result w2 = measure([&]() { return meld<weight_heap>(keys, 2 * n, heaps); }, 2 * n);
+    std::printf("%-6s %-14s %10.3f %14.2f\n", "meld", "dist-based", r2.seconds, r2.compares);
+    std::printf("%-6s %-14s %10.3f %14.2f\n", "meld", "weight-biased", w2.seconds, w2.compares);
+    if (r1.checksum != w1.checksum || r2.checksum != w2.checksum) {
+        std::printf("the two engines popped different keys\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,178 @@
+#include <iostream>
+#include <algorithm>
+#include <vector>
+
+#include "median_tracker.hpp"
+
+int A = 325, B = 2336, last = 233, mod = 1000007;
+
+int Rand(){
+    return last = (A * last + B) % mod;
+}
+
+// Element of rank ceil(q * n) in ascending order.
+int reference(std::vector<int> v, double q) {
+    std::sort(v.begin(), v.end());
+    size_t r = (size_t)(q * v.size());
+    if (r < q * v.size()) ++r;
+    if (r < 1) r = 1;
+    return v[r - 1];
+}
+
+bool testMedian() {
+    sjtu::median_tracker<int> mt;
+    std::vector<sjtu::median_tracker<int>::handle> handles;
+    std::vector<int> values;
+    for (int i = 0; i < 3000; i++) {
+        int v = Rand() % 1000;
+        handles.push_back(mt.insert(v));
+        values.push_back(v);
+        if (i % 3 == 2) {
+            size_t k = Rand() % handles.size();
+            if (sjtu::median_tracker<int>::value(handles[k]) != values[k]) return false;
+            mt.erase(handles[k]);
+            handles.erase(handles.begin() + k);
+            values.erase(values.begin() + k);
+        }
+        if (mt.size() != values.size() || mt.median() != reference(values, 0.5)) return false;
+    }
+    while (!handles.empty()) {
+        mt.erase(handles.back());
+        handles.pop_back();
+        values.pop_back();
+        if (!values.empty() && mt.median() != reference(values, 0.5)) return false;
+    }
+    return mt.empty();
+}
+
+bool testQuantileMerge() {
+    sjtu::quantile_tracker<int> a(0.9), b(0.9);
+    std::vector<int> values;
+    for (int i = 0; i < 2000; i++) {
+        int v = Rand() % 5000;
+        a.insert(v);
+        values.push_back(v);
+    }
+    std::vector<sjtu::quantile_tracker<int>::handle> handles;
+    for (int i = 0; i < 1500; i++) {
+        int v = Rand() % 5000 + 2500;
+        handles.push_back(b.insert(v));
+        values.push_back(v);
+    }
+    if (b.quantile() != reference(std::vector<int>(values.begin() + 2000, values.end()), 0.9)) return false;
+    a.merge(b);
+    if (!b.empty() || a.quantile() != reference(values, 0.9)) return false;
+    // handles taken from b now refer to a
+    for (int i = 0; i < 500; i++) {
+        int v = sjtu::quantile_tracker<int>::value(handles[i]);
+        a.erase(handles[i]);
+        values.erase(std::find(values.begin(), values.end(), v));
+    }
+    return a.size() == values.size() && a.quantile() == reference(values, 0.9);
+}
+
+int fail_after = -1;  // throw on the comparison after this many succeed
+
+struct FaultyCompare {
+    bool operator()(int a, int b) const {
+        if (fail_after >= 0 && fail_after-- == 0)
+            throw 1;
+        return a < b;
+    }
+};
+
+// A merge that fails part way, even after the melds or while swapping
+// misplaced elements, leaves both trackers as they were.
+bool testMergeRollback() {
+    typedef sjtu::quantile_tracker<int, FaultyCompare> tracker;
+    int failures = 0;
+    for (int round = 0; round < 200; round++) {
+        tracker a(0.5), b(0.5);
+        std::vector<int> va, vb;
+        std::vector<tracker::handle> hb;
+        for (int i = 0; i < 300; i++) {
+            int v = Rand() % 1000;
+            a.insert(v);
+            va.push_back(v);
+            v = Rand() % 1000 + 400;
+            hb.push_back(b.insert(v));
+            vb.push_back(v);
+        }
+        fail_after = Rand() % 2000;
+        try {
+            a.merge(b);
+            fail_after = -1;
+            va.insert(va.end(), vb.begin(), vb.end());
+            vb.clear();
+        } catch (const sjtu::runtime_error &) {
+            fail_after = -1;
+            ++failures;
+            if (b.quantile() != reference(vb, 0.5)) return false;
+            // b's handles still belong to b
+            b.erase(hb[0]);
+            vb.erase(vb.begin());
+        }
+        if (a.size() != va.size() || b.size() != vb.size()) return false;
+        if (a.quantile() != reference(va, 0.5)) return false;
+        if (!vb.empty() && b.quantile() != reference(vb, 0.5)) return false;
+    }
+    return failures > 50 && failures < 200;
+}
+
+// An insert or erase that fails at any comparison leaves the tracker as it
+// was, with every handle still usable.
+bool testUpdateRollback() {
+    typedef sjtu::median_tracker<int, FaultyCompare> tracker;
+    int failures = 0;
+    for (int round = 0; round < 60; round++) {
+        tracker t;
+        std::vector<tracker::handle> handles;
+        std::vector<int> values;
+        for (int i = 0; i < 50; i++) {
+            int v = Rand() % 100;
+            handles.push_back(t.insert(v));
+            values.push_back(v);
+        }
+        fail_after = round % 8;
+        try {
+            if (round % 2) {
+                t.erase(handles[round % 50]);
+                handles.erase(handles.begin() + round % 50);
+                values.erase(values.begin() + round % 50);
+            } else {
+                handles.push_back(t.insert(Rand() % 100));
+                values.push_back(tracker::value(handles.back()));
+            }
+        } catch (const sjtu::runtime_error &) {
+            ++failures;
+        }
+        fail_after = -1;
+        if (t.size() != values.size() || t.median() != reference(values, 0.5)) return false;
+        while (!handles.empty()) {
+            t.erase(handles.back());
+            handles.pop_back();
+            values.pop_back();
+            if (!values.empty() && t.median() != reference(values, 0.5)) return false;
+        }
+        if (!t.empty()) return false;
+    }
+    return failures > 15;
+}
+
+bool testException() {
+    sjtu::median_tracker<int> mt;
+    try {
+        mt.median();
+        return false;
+    } catch (const sjtu::container_is_empty &) {}
+    return true;
+}
+
+int main() {
+    std::cout << (testMedian() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testQuantileMerge() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testException() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testMergeRollback() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testUpdateRollback() ? "OKAY" : "FAIL") << std::endl;
+    return 0;
+}
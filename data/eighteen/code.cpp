@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include "batch_priority_queue.hpp"
+
+int A = 325, B = 2336, last = 233, mod = 1000007;
+
+int Rand(){
+    return last = (A * last + B) % mod;
+}
+
+// Rounds of insert_batch and delete_top_k against a sorted reference.
+template<class Policy>
+bool testRounds(unsigned shards, const Policy &policy, int keyRange) {
+    sjtu::batch_priority_queue<int> q(shards);
+    std::vector<int> ref;  // kept sorted from best to worst
+    for (int round = 0; round < 200; round++) {
+        std::vector<int> batch(Rand() % 600);
+        for (int &x : batch) x = Rand() % keyRange;
+        q.insert_batch(policy, batch.begin(), batch.end());
+        for (int x : batch) ref.push_back(x);
+        std::sort(ref.begin(), ref.end(), std::greater<int>());
+        if (q.size() != ref.size()) return false;
+        if (!ref.empty() && q.top() != ref[0]) return false;
+
+        size_t k = Rand() % (round % 50 == 49 ? 2000 : 400);
+        std::vector<int> out;
+        q.delete_top_k(policy, k, std::back_inserter(out));
+        size_t expected = std::min(k, ref.size());
+        if (out.size() != expected || !std::equal(out.begin(), out.end(), ref.begin())) return false;
+        ref.erase(ref.begin(), ref.begin() + expected);
+        if (q.size() != ref.size()) return false;
+    }
+    std::vector<int> rest;
+    q.delete_top_k(q.size() + 5, std::back_inserter(rest));
+    return rest == ref && q.empty();
+}
+
+// All the best elements sit in one shard, so the merge has to refill it.
+bool testSkewed() {
+    sjtu::batch_priority_queue<int> q(4);
+    for (int i = 0; i < 1000; i++) q.push(i % 4 == 0 ? 100000 + i : i);
+    std::vector<int> low(3000);
+    for (int &x : low) x = Rand() % 1000;
+    q.insert_batch(low.begin(), low.end());
+    std::vector<int> out(300);
+    q.delete_top_k(sjtu::execution::par(4), 300, out.begin());
+    for (int i = 0; i < 250; i++) {
+        if (out[i] != 100000 + 996 - 4 * i) return false;
+    }
+    return std::is_sorted(out.begin(), out.end(), std::greater<int>()) && q.size() == 3700;
+}
+
+int failAfter = -1;  // compares left before FaultyCompare throws; -1: never
+
+struct FaultyCompare {
+    bool operator()(int a, int b) const {
+        if (failAfter >= 0 && failAfter-- == 0) throw sjtu::runtime_error();
+        if (a == 777 || b == 777) throw sjtu::runtime_error();
+        return a < b;
+    }
+};
+
+bool testException() {
+    sjtu::batch_priority_queue<int, FaultyCompare> q(3);
+    try {
+        q.top();
+        return false;
+    } catch (const sjtu::container_is_empty &) {}
+    std::vector<int> batch;
+    for (int i = 0; i < 500; i++) batch.push_back(i * 2);
+    q.insert_batch(sjtu::execution::par(3), batch.begin(), batch.end());
+    std::vector<int> bad(batch);
+    bad[100] = 777;
+    try {
+        q.insert_batch(bad.begin(), bad.end());
+        return false;
+    } catch (const sjtu::runtime_error &) {}
+    if (q.size() != 500) return false;
+    // Fail at ever later compares until delete_top_k gets through; every
+    // failed attempt must leave the queue as it was.
+    std::vector<int> out;
+    for (int fail = 0; fail < 20000; fail += 37) {
+        failAfter = fail;
+        try {
+            q.delete_top_k(60, std::back_inserter(out));
+            failAfter = -1;
+            return out.size() == 60 && out[0] == 998 && out[59] == 880 && q.size() == 440;
+        } catch (const sjtu::runtime_error &) {}
+        failAfter = -1;
+        if (!out.empty() || q.size() != 500 || q.top() != 998) return false;
+    }
+    return false;
+}
+
+int main() {
+    std::cout << (testRounds(1, sjtu::execution::seq, 1000000) ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testRounds(4, sjtu::execution::par(4), 1000000) ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testRounds(7, sjtu::execution::par(2), 50) ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testSkewed() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testException() ? "OKAY" : "FAIL") << std::endl;
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <iostream>
+#include <queue>
+#include <vector>
+
+#include "weak_heap.hpp"
+
+int A = 325, B = 2336, last = 233, mod = 1000007;
+
+int Rand(){
+    return last = (A * last + B) % mod;
+}
+
+const int TRIGGER_VALUE = 100;
+bool force_exception = false;
+int fail_after = -1;  // throw on the comparison after this many succeed
+long long compares = 0;
+
+struct FaultyCompare {
+    bool operator()(int a, int b) const {
+        if (force_exception || a == TRIGGER_VALUE || b == TRIGGER_VALUE)
+            throw sjtu::runtime_error();
+        if (fail_after >= 0 && fail_after-- == 0)
+            throw sjtu::runtime_error();
+        ++compares;
+        return a < b;
+    }
+};
+
+std::vector<int> drain(sjtu::weak_heap<int, FaultyCompare> h) {
+    std::vector<int> out;
+    while (!h.empty()) {
+        out.push_back(h.top());
+        h.pop();
+    }
+    return out;
+}
+
+bool testAgainstStd() {
+    sjtu::weak_heap<int, FaultyCompare> h;
+    std::priority_queue<int> ref;
+    for (int i = 0; i < 100000; i++) {
+        int op = Rand() % 3;
+        if (op < 2 || ref.empty()) {
+            int v = Rand() % 1000 + 200;
+            h.push(v);
+            ref.push(v);
+        } else {
+            if (h.top() != ref.top()) return false;
+            h.pop();
+            ref.pop();
+        }
+        if (h.size() != ref.size()) return false;
+    }
+    while (!ref.empty()) {
+        if (h.top() != ref.top()) return false;
+        h.pop();
+        ref.pop();
+    }
+    return h.empty();
+}
+
+bool testBuildCompares() {
+    std::vector<int> v;
+    for (int i = 0; i < 4096; i++) v.push_back(Rand() % 100000 + 200);
+    compares = 0;
+    sjtu::weak_heap<int, FaultyCompare> h(v.begin(), v.end());
+    if (compares != 4095) return false;
+    compares = 0;
+    h.pop();
+    // popping from 4096 elements walks a path of at most log2(4095) joins
+    return compares <= 12;
+}
+
+bool testRollback() {
+    sjtu::weak_heap<int, FaultyCompare> h, other;
+    for (int i = 0; i < 500; i++) h.push(Rand() % 90 + 1);
+    for (int i = 0; i < 300; i++) other.push(Rand() % 90 + 1);
+    std::vector<int> before = drain(h), otherBefore = drain(other);
+
+    try {
+        h.push(TRIGGER_VALUE);
+        return false;
+    } catch (const sjtu::runtime_error &) {}
+    if (drain(h) != before) return false;
+
+    // fail after a few successful joins of the sift-down
+    for (int skip = 0; skip < 8; skip++) {
+        sjtu::weak_heap<int, FaultyCompare> copy(h);
+        bool thrown = false;
+        try {
+            fail_after = skip;
+            copy.pop();
+        } catch (const sjtu::runtime_error &) {
+            thrown = true;
+        }
+        fail_after = -1;
+        if (!thrown || drain(copy) != before) return false;
+    }
+
+    try {
+        force_exception = true;
+        h.merge(other);
+        force_exception = false;
+        return false;
+    } catch (const sjtu::runtime_error &) {
+        force_exception = false;
+    }
+    if (drain(h) != before || drain(other) != otherBefore) return false;
+
+    h.merge(other);
+    return other.empty() && h.size() == 800;
+}
+
+int main() {
+    std::cout << (testAgainstStd() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testBuildCompares() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testRollback() ? "OKAY" : "FAIL") << std::endl;
+    return 0;
+}
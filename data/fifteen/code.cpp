@@ -0,0 +1,103 @@
+#include <iostream>
+#include <queue>
+
+#include "compressed_priority_queue.hpp"
+
+unsigned long long seed = 88172645463325252ull;
+
+unsigned long long Rand() {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return seed;
+}
+
+template<class UInt>
+bool testAgainstStd(size_t hotLimit, int shift) {
+    sjtu::compressed_priority_queue<UInt> pq(hotLimit);
+    std::priority_queue<UInt> ref;
+    for (int i = 0; i < 200000; i++) {
+        if (Rand() % 5 < 3 || ref.empty()) {
+            UInt v = (UInt)(Rand() >> shift);
+            pq.push(v);
+            ref.push(v);
+        } else {
+            if (pq.top() != ref.top()) return false;
+            pq.pop();
+            ref.pop();
+        }
+        if (pq.size() != ref.size()) return false;
+    }
+    sjtu::compressed_priority_queue<UInt> copy(pq);
+    while (!ref.empty()) {
+        if (pq.top() != ref.top() || copy.top() != ref.top()) return false;
+        pq.pop();
+        copy.pop();
+        ref.pop();
+    }
+    return pq.empty() && copy.empty() && pq.run_count() == 0;
+}
+
+bool testMerge() {
+    sjtu::compressed_priority_queue<unsigned> a(100), b(37);
+    std::priority_queue<unsigned> ref;
+    for (int i = 0; i < 5000; i++) {
+        unsigned v = (unsigned)Rand();
+        (i % 2 ? a : b).push(v);
+        ref.push(v);
+    }
+    a.merge(b);
+    if (!b.empty() || a.size() != ref.size()) return false;
+    while (!ref.empty()) {
+        if (a.top() != ref.top()) return false;
+        a.pop();
+        ref.pop();
+    }
+    try {
+        a.top();
+        return false;
+    } catch (const sjtu::container_is_empty &) {}
+    return true;
+}
+
+// Merging many flushed queues one by one keeps the runs size-tiered.
+bool testRepeatedMerge() {
+    sjtu::compressed_priority_queue<unsigned> all(64);
+    std::priority_queue<unsigned> ref;
+    for (int q = 0; q < 300; q++) {
+        sjtu::compressed_priority_queue<unsigned> part(64);
+        for (int i = 0; i < 200; i++) {
+            unsigned v = (unsigned)Rand();
+            part.push(v);
+            ref.push(v);
+        }
+        all.merge(part);
+        // Each run is more than twice the next: at most log2(n) + 1 runs.
+        size_t bound = 1;
+        for (size_t n = all.size(); n > 1; n /= 2) ++bound;
+        if (all.run_count() > bound) return false;
+    }
+    while (!ref.empty()) {
+        if (all.top() != ref.top()) return false;
+        all.pop();
+        ref.pop();
+    }
+    return all.empty();
+}
+
+bool testCompression() {
+    // dense keys: deltas fit in one byte
+    sjtu::compressed_priority_queue<unsigned long long> pq(4096);
+    for (int i = 0; i < 1000000; i++) pq.push(Rand() % 10000000);
+    return pq.cold_bytes() < 2 * pq.size();
+}
+
+int main() {
+    std::cout << (testAgainstStd<unsigned long long>(1000, 0) ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testAgainstStd<unsigned long long>(7, 40) ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testAgainstStd<unsigned char>(50, 0) ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testMerge() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testCompression() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testRepeatedMerge() ? "OKAY" : "FAIL") << std::endl;
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <iostream>
+#include <algorithm>
+#include <vector>
+
+#include "priority_queue.hpp"
+#include "execution.hpp"
+
+int A = 325, B = 2336, last = 233, mod = 1000007;
+
+int Rand(){
+    return last = (A * last + B) % mod;
+}
+
+const int TRIGGER_VALUE = -1;
+
+struct FaultyCompare {
+    bool operator()(int a, int b) const {
+        if (a == TRIGGER_VALUE || b == TRIGGER_VALUE)
+            throw sjtu::runtime_error();
+        return a < b;
+    }
+};
+
+template<class PQ>
+bool drainsSorted(PQ &pq, std::vector<int> sorted) {
+    std::sort(sorted.begin(), sorted.end());
+    if (pq.size() != sorted.size()) return false;
+    while (!sorted.empty()) {
+        if (pq.top() != sorted.back()) return false;
+        pq.pop();
+        sorted.pop_back();
+    }
+    return pq.empty();
+}
+
+bool testRangeConstructor() {
+    std::vector<int> v;
+    for (int i = 0; i < 100000; i++) v.push_back(Rand());
+    sjtu::priority_queue<int> pq(v.begin(), v.end());
+    sjtu::priority_queue<int> empty(v.begin(), v.begin());
+    return drainsSorted(pq, v) && empty.empty();
+}
+
+bool testParallelConstructor() {
+    std::vector<int> v;
+    for (int i = 0; i < 300000; i++) v.push_back(Rand() % 1000);
+    for (unsigned threads = 1; threads <= 5; threads++) {
+        sjtu::priority_queue<int> pq(sjtu::execution::par(threads), v.begin(), v.end());
+        pq.push(1000);
+        v.push_back(1000);
+        if (!drainsSorted(pq, v)) return false;
+        v.pop_back();
+    }
+    sjtu::priority_queue<int> pq(sjtu::execution::seq, v.begin(), v.end());
+    return drainsSorted(pq, v);
+}
+
+bool testException() {
+    std::vector<int> v;
+    for (int i = 0; i < 10000; i++) v.push_back(Rand());
+    v[7777] = TRIGGER_VALUE;
+    try {
+        sjtu::priority_queue<int, FaultyCompare> pq(sjtu::execution::par(4), v.begin(), v.end());
+        return false;
+    } catch (const sjtu::runtime_error &) {}
+    try {
+        sjtu::priority_queue<int, FaultyCompare> pq(v.begin(), v.end());
+        return false;
+    } catch (const sjtu::runtime_error &) {}
+    return true;
+}
+
+int main() {
+    std::cout << (testRangeConstructor() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testParallelConstructor() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testException() ? "OKAY" : "FAIL") << std::endl;
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include <iostream>
+#include <vector>
+
+#include "expiring_queue.hpp"
+
+int A = 325, B = 2336, last = 233, mod = 1000007;
+
+int Rand(){
+    return last = (A * last + B) % mod;
+}
+
+struct Entry {
+    int value;
+    unsigned long long expiry;
+    bool alive;
+};
+
+// Largest value among entries still alive in the reference.
+int referenceTop(const std::vector<Entry> &ref) {
+    int best = -1;
+    for (const Entry &e : ref) if (e.alive && e.value > best) best = e.value;
+    return best;
+}
+
+bool testExpiry(unsigned long long slotWidth, size_t slots) {
+    sjtu::expiring_queue<int> q(slotWidth, slots);
+    std::vector<Entry> ref;
+    size_t alive = 0;
+    unsigned long long now = 0;
+    for (int round = 0; round < 4000; round++) {
+        int pushes = Rand() % 4;
+        for (int i = 0; i < pushes; i++) {
+            int v = Rand() % 1000 * 100000 + (int)ref.size();  // unique values
+            unsigned long long ttl = Rand() % 3000 + 1;
+            if (!q.push_for(v, ttl)) return false;
+            ref.push_back(Entry{v, now + ttl, true});
+            ++alive;
+        }
+        if (Rand() % 3 == 0 && alive > 0) {
+            int top = referenceTop(ref);
+            if (q.top() != top) return false;
+            for (Entry &e : ref) {
+                if (e.alive && e.value == top) {
+                    e.alive = false;
+                    break;
+                }
+            }
+            --alive;
+            q.pop();
+        }
+        now += Rand() % (round % 500 == 0 ? 5000 : 4);
+        size_t expected = 0;
+        for (Entry &e : ref) {
+            if (e.alive && e.expiry <= now) {
+                e.alive = false;
+                ++expected;
+            }
+        }
+        alive -= expected;
+        if (q.advance_time(now) != expected) return false;
+        if (q.size() != alive) return false;
+        if (alive > 0 && q.top() != referenceTop(ref)) return false;
+    }
+    sjtu::expiring_queue<int> copy(q);
+    if (copy.size() != q.size()) return false;
+    size_t expired = copy.advance_time(now + 1000000);
+    return expired == alive && copy.empty() && q.size() == alive && !q.push(1, now);
+}
+
+bool testException() {
+    sjtu::expiring_queue<int> q;
+    try {
+        q.top();
+        return false;
+    } catch (const sjtu::container_is_empty &) {}
+    try {
+        q.pop();
+        return false;
+    } catch (const sjtu::container_is_empty &) {}
+    return true;
+}
+
+int fail_after = -1;  // throw on the comparison after this many succeed
+
+struct FaultyCompare {
+    bool operator()(int a, int b) const {
+        if (fail_after >= 0 && fail_after-- == 0)
+            throw 1;
+        return a < b;
+    }
+};
+
+// A tombstone left at the root by a failed advance_time() is dropped by
+// the next top() of a non-const queue; a const queue reports it.
+bool testTombstoneAtRoot() {
+    sjtu::expiring_queue<int, FaultyCompare> q;
+    q.push(10, 5);
+    for (int i = 1; i <= 5; i++) q.push(i, 100);
+    fail_after = 0;
+    try {
+        q.advance_time(6);
+        return false;
+    } catch (const sjtu::runtime_error &) {}
+    fail_after = -1;
+    const sjtu::expiring_queue<int, FaultyCompare> &view = q;
+    try {
+        view.top();
+        return false;
+    } catch (const sjtu::runtime_error &) {}
+    return q.size() == 5 && q.top() == 5 && view.top() == 5;
+}
+
+// Ascending values leave one long left chain; copying and destroying it
+// must not recurse.
+bool testChains() {
+    sjtu::expiring_queue<int> q;
+    for (int i = 0; i < 1000000; i++) q.push(i, 1000 + i % 7);
+    sjtu::expiring_queue<int> copy(q), assigned;
+    assigned = copy;
+    if (assigned.advance_time(1003) != 571429 || assigned.size() != 428571) return false;
+    return assigned.top() == 999998 && copy.size() == 1000000 && copy.top() == 999999;
+}
+
+int main() {
+    std::cout << (testExpiry(1, 256) ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testExpiry(16, 8) ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testException() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testTombstoneAtRoot() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testChains() ? "OKAY" : "FAIL") << std::endl;
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+#include "key_encoder.hpp"
+#include "priority_queue.hpp"
+#include "priority_queue_kv.hpp"
+
+int A = 325, B = 2336, last = 233, mod = 1000007;
+
+int Rand(){
+    return last = (A * last + B) % mod;
+}
+
+enum class Level : unsigned char { low, mid, high };
+
+// (signed deadline, descending level, double weight): 24 + 2 + 64 bits.
+typedef sjtu::key_encoder<sjtu::key_field<int, 24>,
+                          sjtu::key_field<Level, 2, sjtu::key_order::descending>,
+                          sjtu::key_field<double>> wide;
+
+// (descending deadline, class, bool): fits in 32 bits.
+typedef sjtu::key_encoder<sjtu::key_field<unsigned, 20, sjtu::key_order::descending>,
+                          sjtu::key_field<unsigned char, 11>,
+                          sjtu::key_field<bool>> narrow;
+
+static_assert(sizeof(narrow::key_type) == 4, "narrow keys fit in 32 bits");
+static_assert(sizeof(wide::key_type) == 16, "wide keys need 128 bits");
+
+double randomDouble() {
+    const double special[] = {0.0, -0.0, 1e-310, -1e-310, 1.5, -1.5,
+                              std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+    if (Rand() % 4 == 0) return special[Rand() % 8];
+    return (Rand() - mod / 2) * std::pow(10.0, Rand() % 40 - 20);
+}
+
+// Same order as the tuples compare, with -0.0 below +0.0.
+bool tupleLess(const wide::tuple_type &a, const wide::tuple_type &b) {
+    if (std::get<0>(a) != std::get<0>(b)) return std::get<0>(a) < std::get<0>(b);
+    if (std::get<1>(a) != std::get<1>(b)) return std::get<1>(a) > std::get<1>(b);
+    double x = std::get<2>(a), y = std::get<2>(b);
+    if (x != y) return x < y;
+    return std::signbit(x) && !std::signbit(y);
+}
+
+bool testOrder() {
+    std::vector<wide::tuple_type> values;
+    for (int i = 0; i < 3000; i++) {
+        values.emplace_back(Rand() % 2000 - 1000, (Level)(Rand() % 3), randomDouble());
+    }
+    values.emplace_back(-(1 << 23), Level::high, 0.0);
+    values.emplace_back((1 << 23) - 1, Level::low, 0.0);
+    for (size_t i = 0; i < values.size(); i++) {
+        const wide::tuple_type &a = values[i];
+        wide::key_type ka = wide::encode(std::get<0>(a), std::get<1>(a), std::get<2>(a));
+        wide::tuple_type back = wide::decode(ka);
+        if (std::get<0>(back) != std::get<0>(a) || std::get<1>(back) != std::get<1>(a) ||
+            std::signbit(std::get<2>(back)) != std::signbit(std::get<2>(a)) ||
+            std::get<2>(back) != std::get<2>(a)) return false;
+        for (int j = 0; j < 20; j++) {
+            const wide::tuple_type &b = values[Rand() % values.size()];
+            wide::key_type kb = wide::encode(std::get<0>(b), std::get<1>(b), std::get<2>(b));
+            if ((ka < kb) != tupleLess(a, b)) return false;
+        }
+    }
+    return true;
+}
+
+bool testNarrow() {
+    for (int i = 0; i < 5000; i++) {
+        unsigned d1 = Rand() % (1 << 20), d2 = Rand() % (1 << 20);
+        unsigned char c1 = Rand() % 2048 % 256, c2 = Rand() % 256;
+        bool f1 = Rand() % 2, f2 = Rand() % 2;
+        narrow::key_type k1 = narrow::encode(d1, c1, f1), k2 = narrow::encode(d2, c2, f2);
+        bool expected = std::make_tuple(d2, c1, f1) < std::make_tuple(d1, c2, f2);
+        if ((k1 < k2) != expected) return false;
+        if (narrow::get<0>(k1) != d1 || narrow::get<1>(k1) != c1 || narrow::get<2>(k1) != f1) return false;
+    }
+    try {
+        narrow::encode(1 << 20, 0, false);
+        return false;
+    } catch (const sjtu::index_out_of_bound &) {}
+    try {
+        wide::encode(1 << 23, Level::low, 0.0);
+        return false;
+    } catch (const sjtu::index_out_of_bound &) {}
+    return true;
+}
+
+// Earliest deadline first, then the higher class, then FIFO.
+bool testQueue() {
+    typedef sjtu::key_encoder<sjtu::key_field<unsigned, 32, sjtu::key_order::descending>,
+                              sjtu::key_field<unsigned char, 4>,
+                              sjtu::key_field<unsigned, 28, sjtu::key_order::descending>> edf;
+    static_assert(sizeof(edf::key_type) == 8, "edf keys fit in 64 bits");
+    sjtu::priority_queue_kv<edf::key_type, int> kv;
+    sjtu::priority_queue<edf::key_type> plain;
+    std::vector<std::tuple<unsigned, int, unsigned>> ref;
+    for (unsigned seq = 0; seq < 5000; seq++) {
+        unsigned deadline = Rand() % 100;
+        unsigned char cls = Rand() % 16;
+        edf::key_type key = edf::encode(deadline, cls, seq);
+        kv.emplace(key, (int)seq);
+        plain.push(key);
+        ref.emplace_back(deadline, -(int)cls, seq);
+    }
+    std::sort(ref.begin(), ref.end());
+    for (const auto &r : ref) {
+        if (kv.top().second != (int)std::get<2>(r) || edf::get<2>(plain.top()) != std::get<2>(r)) return false;
+        if (edf::get<0>(kv.top().first) != std::get<0>(r)) return false;
+        kv.pop();
+        plain.pop();
+    }
+    return kv.empty() && plain.empty();
+}
+
+int main() {
+    std::cout << (testOrder() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testNarrow() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testQueue() ? "OKAY" : "FAIL") << std::endl;
+    return 0;
+}
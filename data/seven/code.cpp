@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "priority_map.hpp"
+
+int A = 325, B = 2336, last = 233, mod = 1000007;
+
+int Rand(){
+    return last = (A * last + B) % mod;
+}
+
+// Reference: brute-force scan of a std::map for the largest priority.
+bool checkTop(const sjtu::priority_map<int, int> &pm, const std::map<int, int> &ref) {
+    if (pm.size() != ref.size()) return false;
+    if (ref.empty()) return pm.empty();
+    int best = ref.begin()->second;
+    for (auto &kv : ref) if (kv.second > best) best = kv.second;
+    return pm.top_priority() == best && ref.at(pm.top_key()) == best;
+}
+
+bool testUpsert() {
+    sjtu::priority_map<int, int> pm;
+    std::map<int, int> ref;
+    for (int i = 0; i < 20000; i++) {
+        int key = Rand() % 3000, p = Rand() % 100000;
+        bool inserted = pm.upsert(key, p);
+        if (inserted != (ref.find(key) == ref.end())) return false;
+        ref[key] = p;
+        if (i % 7 == 0) {
+            int k = Rand() % 3000;
+            if (pm.erase(k) != (ref.erase(k) == 1)) return false;
+        }
+        if (!checkTop(pm, ref)) return false;
+    }
+    for (auto &kv : ref) {
+        if (!pm.contains(kv.first) || pm.priority(kv.first) != kv.second) return false;
+    }
+    while (!pm.empty()) {
+        if (!checkTop(pm, ref)) return false;
+        ref.erase(pm.top_key());
+        pm.pop();
+    }
+    return ref.empty();
+}
+
+bool testMerge() {
+    sjtu::priority_map<int, int> a, b;
+    std::map<int, int> ref;
+    for (int i = 0; i < 5000; i++) {
+        int key = Rand() % 4000, p = Rand() % 100000;
+        a.upsert(key, p);
+        ref[key] = p;
+    }
+    std::map<int, int> refB;
+    for (int i = 0; i < 5000; i++) {
+        int key = Rand() % 4000 + 2000, p = Rand() % 100000;
+        b.upsert(key, p);
+        refB[key] = p;
+    }
+    for (auto &kv : refB) {
+        auto it = ref.find(kv.first);
+        if (it == ref.end() || it->second < kv.second) ref[kv.first] = kv.second;
+    }
+    a.merge(b);
+    if (!b.empty() || b.contains(2500)) return false;
+    for (auto &kv : ref) {
+        if (a.priority(kv.first) != kv.second) return false;
+    }
+    sjtu::priority_map<int, int> c(a);
+    if (c.size() != ref.size() || c.priority(2500) != ref[2500]) return false;
+    while (!a.empty()) {
+        if (!checkTop(a, ref)) return false;
+        ref.erase(a.top_key());
+        a.pop();
+    }
+    return ref.empty();
+}
+
+bool testException() {
+    sjtu::priority_map<std::string, int> pm;
+    try {
+        pm.top_key();
+        return false;
+    } catch (const sjtu::container_is_empty &) {}
+    pm.upsert("a", 1);
+    try {
+        pm.priority("b");
+        return false;
+    } catch (const sjtu::index_out_of_bound &) {}
+    return pm.priority("a") == 1;
+}
+
+// Ascending priorities leave every entry on one left chain; copying,
+// re-indexing and destroying it must not recurse.
+bool testChains() {
+    sjtu::priority_map<int, int> pm;
+    for (int i = 0; i < 2000000; i++) pm.upsert(i, i);
+    sjtu::priority_map<int, int> copy(pm), assigned;
+    assigned = copy;
+    if (copy.size() != 2000000 || assigned.priority(123456) != 123456) return false;
+    long long sum = 0;
+    assigned.for_each([&sum](int key, int p) { sum += key - p + 1; });
+    return sum == 2000000 && assigned.top_key() == 1999999;
+}
+
+struct Reversible {
+    bool reversed;
+    bool operator()(int a, int b) const {
+        return reversed ? b < a : a < b;
+    }
+};
+
+// merge() without a combiner keeps the priority that ranks higher under
+// the map's own comparator.
+bool testComparator() {
+    sjtu::priority_map<int, int, Reversible> a(Reversible{true}), b(Reversible{true});
+    for (int i = 0; i < 1000; i++) {
+        a.upsert(i, i);
+        b.upsert(i + 500, i);
+    }
+    a.merge(b);
+    if (a.size() != 1500 || a.top_priority() != 0) return false;
+    return a.priority(700) == 200 && a.priority(1200) == 700;
+}
+
+int fail_after = -1;  // throw on the comparison after this many succeed
+
+struct FaultyCompare {
+    bool operator()(int a, int b) const {
+        if (fail_after >= 0 && fail_after-- == 0)
+            throw 1;
+        return a < b;
+    }
+};
+
+// A failed upsert of a present key either keeps its old priority (Compare
+// failed while unlinking it) or removes it; the index and the heap must
+// agree in both cases.
+bool testFailedUpsert() {
+    sjtu::priority_map<int, int, FaultyCompare> pm;
+    std::map<int, int> ref;
+    for (int i = 0; i < 3000; i++) {
+        int key = Rand() % 800, p = Rand() % 100000;
+        pm.upsert(key, p);
+        ref[key] = p;
+    }
+    int failures = 0;
+    for (int i = 0; i < 400; i++) {
+        int key = Rand() % 800, p = Rand() % 100000;
+        if (!ref.count(key)) continue;
+        fail_after = Rand() % 24;
+        try {
+            pm.upsert(key, p);
+            ref[key] = p;
+        } catch (const sjtu::runtime_error &) {
+            ++failures;
+            if (!pm.contains(key)) return false;
+        }
+        fail_after = -1;
+        if (pm.size() != ref.size()) return false;
+        if (pm.contains(key) && pm.priority(key) != ref[key]) return false;
+    }
+    if (failures == 0) return false;
+    std::map<int, int> seen;
+    pm.for_each([&seen](int key, int p) { seen[key] = p; });
+    if (seen != ref) return false;
+    while (!pm.empty()) {
+        if (ref.at(pm.top_key()) != pm.top_priority()) return false;
+        ref.erase(pm.top_key());
+        pm.pop();
+    }
+    return ref.empty();
+}
+
+// find() and update() through a handle agree with the keyed calls, and a
+// failed update leaves the entry and its handle as they were.
+bool testHandles() {
+    sjtu::priority_map<int, int, FaultyCompare> pm;
+    std::map<int, int> ref;
+    for (int i = 0; i < 5000; i++) {
+        int key = Rand() % 800, p = Rand() % 100000;
+        auto h = pm.find(key);
+        if ((h != nullptr) != (ref.count(key) == 1)) return false;
+        if (h) {
+            if (pm.priority(h) != ref[key]) return false;
+            pm.update(h, p);
+        } else {
+            pm.upsert(key, p);
+        }
+        ref[key] = p;
+    }
+    int failures = 0;
+    for (int i = 0; i < 400; i++) {
+        int key = Rand() % 800, p = Rand() % 100000;
+        auto h = pm.find(key);
+        if (!h) continue;
+        fail_after = Rand() % 24;
+        try {
+            pm.update(h, p);
+            ref[key] = p;
+        } catch (const sjtu::runtime_error &) {
+            ++failures;
+            if (pm.find(key) != h || pm.priority(h) != ref[key]) return false;
+        }
+        fail_after = -1;
+        if (pm.size() != ref.size()) return false;
+        h = pm.find(key);
+        if (h && pm.priority(h) != ref[key]) return false;
+    }
+    std::map<int, int> seen;
+    pm.for_each([&seen](int key, int p) { seen[key] = p; });
+    return failures > 0 && seen == ref;
+}
+
+// A merge that fails while resolving a shared key keeps the keys it has
+// combined and leaves every other entry of both maps where it was.
+bool testFailedMerge() {
+    int failures = 0;
+    for (int round = 0; round < 100; round++) {
+        sjtu::priority_map<int, int, FaultyCompare> a, b;
+        std::map<int, int> ra, rb;
+        for (int i = 0; i < 200; i++) {
+            int key = Rand() % 300, p = Rand() % 100000;
+            a.upsert(key, p);
+            ra[key] = p;
+            key = Rand() % 300, p = Rand() % 100000;
+            b.upsert(key, p);
+            rb[key] = p;
+        }
+        fail_after = Rand() % 200;
+        try {
+            a.merge(b);
+        } catch (const sjtu::runtime_error &) {
+            ++failures;
+        }
+        fail_after = -1;
+        std::map<int, int> sa, sb;
+        a.for_each([&sa](int key, int p) { sa[key] = p; });
+        b.for_each([&sb](int key, int p) { sb[key] = p; });
+        if (sa.size() != a.size() || sb.size() != b.size()) return false;
+        size_t joined = 0;
+        for (const auto &kv : rb) {
+            if (sb.count(kv.first)) {
+                if (sb[kv.first] != kv.second) return false;
+            } else {
+                int want = ra.count(kv.first) ? std::max(ra[kv.first], kv.second) : kv.second;
+                if (!sa.count(kv.first) || sa[kv.first] != want) return false;
+                if (!ra.count(kv.first)) ++joined;
+            }
+        }
+        for (const auto &kv : ra) {
+            if (!sa.count(kv.first)) return false;
+            if (sa[kv.first] != kv.second && !(rb.count(kv.first) && !sb.count(kv.first))) return false;
+        }
+        if (sa.size() != ra.size() + joined) return false;
+    }
+    return failures > 20;
+}
+
+int main() {
+    std::cout << (testUpsert() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testMerge() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testException() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testChains() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testComparator() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testFailedUpsert() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testHandles() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testFailedMerge() ? "OKAY" : "FAIL") << std::endl;
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "priority_queue.hpp"
+#include "execution.hpp"
+
+int A = 325, B = 2336, last = 233, mod = 1000007;
+
+int Rand(){
+    return last = (A * last + B) % mod;
+}
+
+struct Histogram {
+    long long bins[10] = {};
+};
+
+Histogram addValue(Histogram h, int x) {
+    ++h.bins[x % 10];
+    return h;
+}
+
+Histogram addHistogram(Histogram a, const Histogram &b) {
+    for (int i = 0; i < 10; i++) a.bins[i] += b.bins[i];
+    return a;
+}
+
+bool sameHistogram(const Histogram &a, const Histogram &b) {
+    for (int i = 0; i < 10; i++) if (a.bins[i] != b.bins[i]) return false;
+    return true;
+}
+
+std::vector<int> drain(sjtu::priority_queue<int> pq) {
+    std::vector<int> out;
+    while (!pq.empty()) {
+        out.push_back(pq.top());
+        pq.pop();
+    }
+    return out;
+}
+
+template<class Policy>
+bool checkScans(const sjtu::priority_queue<int> &pq, const std::vector<int> &ref, const Policy &policy) {
+    long long sum = 0, even = 0;
+    Histogram hist;
+    for (int x : ref) {
+        sum += x;
+        even += x % 2 == 0;
+        hist = addValue(hist, x);
+    }
+
+    long long seen = 0;
+    pq.for_each([&](int x) { seen += x; });
+    if (seen != sum) return false;
+    if (pq.count_if([](int x) { return x % 2 == 0; }) != (size_t)even) return false;
+    if (pq.reduce(7LL, [](long long acc, int x) { return acc + x; }) != sum + 7) return false;
+    if (!sameHistogram(pq.reduce(Histogram(), addValue), hist)) return false;
+
+    size_t calls = 0;
+    pq.for_each(policy, [&](int) { __atomic_add_fetch(&calls, 1, __ATOMIC_RELAXED); });
+    if (calls != ref.size()) return false;
+    if (pq.count_if(policy, [](int x) { return x % 2 == 0; }) != (size_t)even) return false;
+    auto add = [](long long acc, long long x) { return acc + x; };
+    if (pq.reduce(policy, 7LL, add) != sum + 7) return false;
+    return sameHistogram(pq.reduce(policy, Histogram(), addValue, addHistogram), hist);
+}
+
+bool testRandom() {
+    sjtu::priority_queue<int> pq;
+    std::vector<int> ref;
+    for (int i = 0; i < 100000; i++) {
+        int x = Rand();
+        pq.push(x);
+        ref.push_back(x);
+    }
+    std::vector<int> before = drain(pq);
+    if (!checkScans(pq, ref, sjtu::execution::seq)) return false;
+    if (!checkScans(pq, ref, sjtu::execution::par(4))) return false;
+    if (!checkScans(pq, ref, sjtu::execution::par(3))) return false;
+    // The scans must leave the heap exactly as it was.
+    return pq.size() == ref.size() && drain(pq) == before;
+}
+
+// Elements visited by the busiest thread of a parallel for_each.
+size_t busiestThread(const sjtu::priority_queue<int> &pq, unsigned threads) {
+    std::mutex lock;
+    std::map<std::thread::id, size_t> seen;
+    pq.for_each(sjtu::execution::par(threads), [&](int) {
+        std::lock_guard<std::mutex> guard(lock);
+        ++seen[std::this_thread::get_id()];
+    });
+    size_t most = 0;
+    for (const auto &kv : seen) most = std::max(most, kv.second);
+    return most;
+}
+
+bool testLeftChain() {
+    // Increasing pushes make every new root's old root its left child, so
+    // every dist is 0; the scan must still be shared between threads.
+    sjtu::priority_queue<int> pq;
+    std::vector<int> ref;
+    for (int i = 0; i < 20000; i++) {
+        pq.push(i);
+        ref.push_back(i);
+    }
+    return checkScans(pq, ref, sjtu::execution::par(8)) && busiestThread(pq, 4) <= ref.size() / 2;
+}
+
+bool testEmpty() {
+    sjtu::priority_queue<int> pq;
+    if (pq.count_if([](int) { return true; }) != 0) return false;
+    if (pq.count_if(sjtu::execution::par(4), [](int) { return true; }) != 0) return false;
+    return pq.reduce(sjtu::execution::par(4), 5, [](int a, int b) { return a + b; }) == 5;
+}
+
+int main() {
+    std::cout << (testRandom() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testLeftChain() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testEmpty() ? "OKAY" : "FAIL") << std::endl;
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "fair_scheduler.hpp"
+
+int A = 325, B = 2336, last = 233, mod = 1000007;
+
+int Rand(){
+    return last = (A * last + B) % mod;
+}
+
+typedef sjtu::fair_scheduler<int, int> scheduler;
+
+bool near(size_t got, size_t want) {
+    return got + 1 >= want && got <= want + 1;
+}
+
+// Dispatch n jobs, counting them per tenant and checking that every tenant's
+// jobs leave in non-increasing order.
+bool dispatch(scheduler &s, size_t n, std::vector<size_t> &count, std::vector<int> &prev) {
+    for (size_t i = 0; i < n; i++) {
+        int t = s.top_tenant(), job = s.top();
+        if (t >= (int)count.size()) count.resize(t + 1, 0);
+        if (t >= (int)prev.size()) prev.resize(t + 1, mod);
+        if (job > prev[t]) return false;
+        prev[t] = job;
+        ++count[t];
+        s.pop();
+    }
+    return true;
+}
+
+bool testWeights() {
+    scheduler s;
+    const double weights[3] = {3, 2, 1};
+    for (int t = 0; t < 3; t++) {
+        s.add_tenant(t, weights[t]);
+        for (int i = 0; i < 2000; i++) s.push(t, Rand());
+    }
+    std::vector<size_t> count;
+    std::vector<int> prev;
+    if (!dispatch(s, 600, count, prev)) return false;
+    return near(count[0], 300) && near(count[1], 200) && near(count[2], 100) && s.size() == 5400;
+}
+
+bool testIdleCredit() {
+    scheduler s;
+    for (int t = 0; t < 2; t++) {
+        for (int i = 0; i < 1000; i++) s.push(t, Rand());
+    }
+    std::vector<size_t> count;
+    std::vector<int> prev;
+    if (!dispatch(s, 500, count, prev)) return false;
+    // A tenant that was idle so far only gets its share from now on.
+    for (int i = 0; i < 1000; i++) s.push(2, Rand());
+    count.assign(3, 0);
+    if (!dispatch(s, 300, count, prev)) return false;
+    return near(count[0], 100) && near(count[1], 100) && near(count[2], 100);
+}
+
+bool testCost() {
+    scheduler s;
+    for (int i = 0; i < 1000; i++) {
+        s.push(0, Rand(), 2);
+        s.push(1, Rand(), 1);
+    }
+    std::vector<size_t> count;
+    std::vector<int> prev;
+    if (!dispatch(s, 300, count, prev)) return false;
+    return near(count[0], 100) && near(count[1], 200);
+}
+
+bool testMigrate() {
+    scheduler a, b;
+    size_t pushed = 0;
+    for (int t = 0; t < 6; t++) {
+        a.add_tenant(t, t + 1);
+        for (int i = 0; i < 300; i++, pushed++) a.push(t, Rand());
+    }
+    for (int t = 4; t < 9; t++) {
+        for (int i = 0; i < 200; i++, pushed++) b.push(t, Rand());
+    }
+    size_t backlog = a.backlog(2);
+    a.migrate(2, b);
+    if (a.contains(2) || b.backlog(2) != backlog || b.weight(2) != 3) return false;
+    a.migrate(5, b);
+    if (b.backlog(5) != 500 || b.weight(5) != 1) return false;
+    if (a.size() + b.size() != pushed) return false;
+    try {
+        a.migrate(2, b);
+        return false;
+    } catch (const sjtu::index_out_of_bound &) {}
+
+    b.merge(a);
+    if (!a.empty() || a.tenant_count() != 0 || b.tenant_count() != 9 || b.size() != pushed) return false;
+    std::vector<size_t> count;
+    std::vector<int> prev;
+    if (!dispatch(b, pushed, count, prev)) return false;
+    return b.empty() && b.tenant_count() == 9 && count[4] == 500 && count[0] == 300;
+}
+
+struct FaultyCompare {
+    bool operator()(int a, int b) const {
+        if (a == 100 || b == 100) throw sjtu::runtime_error();
+        return a < b;
+    }
+};
+
+bool testException() {
+    sjtu::fair_scheduler<std::string, int, FaultyCompare> s;
+    try {
+        s.top();
+        return false;
+    } catch (const sjtu::container_is_empty &) {}
+    try {
+        s.add_tenant("zero", 0);
+        return false;
+    } catch (const sjtu::runtime_error &) {}
+    s.push("a", 1);
+    s.push("a", 2);
+    s.push("b", 3);
+    try {
+        s.push("a", 100);
+        return false;
+    } catch (const sjtu::runtime_error &) {}
+    if (s.size() != 3 || s.backlog("a") != 2) return false;
+    if (s.remove_tenant("c") || !s.remove_tenant("b")) return false;
+    if (s.size() != 2 || s.top_tenant() != "a" || s.top() != 2) return false;
+    s.pop();
+    s.pop();
+    return s.empty() && s.tenant_count() == 1 && s.virtual_time() == 2;
+}
+
+int main() {
+    std::cout << (testWeights() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testIdleCredit() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testCost() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testMigrate() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testException() ? "OKAY" : "FAIL") << std::endl;
+    return 0;
+}
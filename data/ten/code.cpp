@@ -0,0 +1,109 @@
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "priority_queue_kv.hpp"
+
+int A = 325, B = 2336, last = 233, mod = 1000007;
+
+int Rand(){
+    return last = (A * last + B) % mod;
+}
+
+int copies = 0, moves = 0;
+
+// Payload that counts how often it is copied or moved.
+struct Payload {
+    std::string text;
+    int id;
+    Payload(const std::string &t, int i) : text(t), id(i) {}
+    Payload(const Payload &other) : text(other.text), id(other.id) { ++copies; }
+    Payload(Payload &&other) : text(std::move(other.text)), id(other.id) { ++moves; }
+    Payload &operator=(const Payload &other) { text = other.text; id = other.id; ++copies; return *this; }
+    Payload &operator=(Payload &&other) { text = std::move(other.text); id = other.id; ++moves; return *this; }
+};
+
+// Only keys may ever be compared.
+struct KeyCompare {
+    bool operator()(int a, int b) const {
+        if (a < 0 || b < 0) throw sjtu::runtime_error();
+        return a < b;
+    }
+};
+
+bool testEmplace() {
+    sjtu::priority_queue_kv<int, Payload, KeyCompare> pq;
+    std::vector<int> keys;
+    for (int i = 0; i < 1000; i++) {
+        int k = Rand() % 100000;
+        pq.emplace(k, "payload", i);
+        keys.push_back(k);
+    }
+    if (copies != 0 || moves != 0) return false;
+    std::sort(keys.begin(), keys.end());
+    while (!pq.empty()) {
+        if (pq.top().first != keys.back() || pq.top().second.text != "payload") return false;
+        keys.pop_back();
+        pq.pop();
+    }
+    return copies == 0 && moves == 0;
+}
+
+bool testPairForwarding() {
+    copies = moves = 0;
+    Payload p("moved", 1);
+    sjtu::pair<int, Payload> a(3, std::move(p));
+    if (copies != 0 || moves != 1) return false;
+    sjtu::pair<int, Payload> b(std::move(a));
+    sjtu::pair<int, Payload> c(0, Payload("x", 2));
+    c = std::move(b);
+    if (copies != 0 || c.second.text != "moved") return false;
+
+    sjtu::priority_queue_kv<int, Payload, KeyCompare> pq;
+    pq.push(std::move(c));
+    return copies == 0 && pq.top().second.id == 1;
+}
+
+bool testMergeAndException() {
+    sjtu::priority_queue_kv<int, Payload, KeyCompare> pq1, pq2;
+    for (int i = 0; i < 100; i++) {
+        pq1.emplace(Rand() % 1000, "a", i);
+        pq2.emplace(Rand() % 1000 + 1000, "b", i);
+    }
+    sjtu::priority_queue_kv<int, Payload, KeyCompare> backup(pq1);
+    try {
+        pq1.emplace(-1, "bad", 0);
+        return false;
+    } catch (const sjtu::runtime_error &) {}
+    if (pq1.size() != 100 || pq1.top().first != backup.top().first) return false;
+    pq1.merge(pq2);
+    if (pq1.size() != 200 || !pq2.empty() || pq1.top().second.text != "b") return false;
+    try {
+        pq2.pop();
+        return false;
+    } catch (const sjtu::container_is_empty &) {}
+    return true;
+}
+
+// Ascending keys leave one long left chain; copying and destroying it
+// must not recurse.
+bool testChains() {
+    sjtu::priority_queue_kv<int, int> q;
+    for (int i = 0; i < 2000000; i++) q.emplace(i, -i);
+    sjtu::priority_queue_kv<int, int> copy(q), assigned;
+    assigned = copy;
+    for (int i = 1999999; i > 1999000; i--) {
+        if (assigned.top().first != i || assigned.top().second != -i) return false;
+        assigned.pop();
+    }
+    return copy.size() == 2000000 && copy.top().first == 1999999;
+}
+
+int main() {
+    std::cout << (testEmplace() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testPairForwarding() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testMergeAndException() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testChains() ? "OKAY" : "FAIL") << std::endl;
+    return 0;
+}
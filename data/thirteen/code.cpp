@@ -0,0 +1,84 @@
+#include <iostream>
+#include <functional>
+
+#include "static_priority_queue.hpp"
+
+// Total weighted code length of a Huffman code, computed at compile time.
+constexpr long long huffmanCost(const int *freq, int n) {
+    sjtu::static_priority_queue<long long, 64, std::greater<long long>> pq;
+    for (int i = 0; i < n; i++) pq.push(freq[i]);
+    long long cost = 0;
+    while (pq.size() > 1) {
+        long long a = pq.top();
+        pq.pop();
+        long long b = pq.top();
+        pq.pop();
+        cost += a + b;
+        pq.push(a + b);
+    }
+    return cost;
+}
+
+struct Job {
+    int deadline = 0;
+    int id = 0;
+};
+
+struct EarliestDeadline {
+    constexpr bool operator()(const Job &a, const Job &b) const {
+        return a.deadline != b.deadline ? a.deadline > b.deadline : a.id > b.id;
+    }
+};
+
+struct Schedule {
+    int order[8] = {};
+};
+
+// Earliest-deadline-first dispatch order, computed at compile time.
+constexpr Schedule edfOrder() {
+    sjtu::static_priority_queue<Job, 8, EarliestDeadline> pq;
+    const int deadlines[8] = {40, 10, 30, 10, 70, 20, 60, 50};
+    for (int i = 0; i < 8; i++) pq.push(Job{deadlines[i], i});
+    Schedule s;
+    for (int i = 0; !pq.empty(); i++) {
+        s.order[i] = pq.top().id;
+        pq.pop();
+    }
+    return s;
+}
+
+constexpr int freq[] = {45, 13, 12, 16, 9, 5};
+constexpr long long cost = huffmanCost(freq, 6);
+static_assert(cost == 224, "Huffman cost must be computed at compile time");
+
+constexpr Schedule schedule = edfOrder();
+static_assert(schedule.order[0] == 1 && schedule.order[1] == 3 && schedule.order[7] == 4,
+              "EDF order must be computed at compile time");
+
+bool testRuntime() {
+    sjtu::static_priority_queue<int, 4> pq;
+    for (int i = 0; i < 4; i++) pq.push(i * 7 % 5);
+    try {
+        pq.push(9);
+        return false;
+    } catch (const sjtu::index_out_of_bound &) {}
+    int prev = pq.top();
+    while (!pq.empty()) {
+        if (pq.top() > prev) return false;
+        prev = pq.top();
+        pq.pop();
+    }
+    try {
+        pq.pop();
+        return false;
+    } catch (const sjtu::container_is_empty &) {}
+    return true;
+}
+
+int main() {
+    std::cout << cost << std::endl;
+    for (int i = 0; i < 8; i++) std::cout << schedule.order[i] << " ";
+    std::cout << std::endl;
+    std::cout << (testRuntime() ? "OKAY" : "FAIL") << std::endl;
+    return 0;
+}
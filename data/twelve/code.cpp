@@ -0,0 +1,129 @@
+#include <iostream>
+#include <algorithm>
+#include <vector>
+
+#include "soft_heap.hpp"
+
+int A = 325, B = 2336, last = 233, mod = 1000007;
+
+int Rand(){
+    return last = (A * last + B) % mod;
+}
+
+bool testCorruptionBound(double epsilon) {
+    sjtu::soft_heap<int> heap(epsilon);
+    std::vector<int> popped;
+    size_t inserted = 0, maxCorrupted = 0;
+    for (int i = 0; i < 60000; i++) {
+        if (Rand() % 3 != 0 || heap.empty()) {
+            heap.insert(Rand());
+            ++inserted;
+        } else {
+            popped.push_back(heap.top());
+            heap.pop();
+        }
+        if (i % 997 == 0) maxCorrupted = std::max(maxCorrupted, heap.corrupted_count());
+    }
+    if (maxCorrupted > epsilon * inserted) return false;
+    if (heap.size() + popped.size() != inserted) return false;
+
+    size_t drained = 0;
+    while (!heap.empty()) {
+        heap.pop();
+        ++drained;
+    }
+    return drained + popped.size() == inserted;
+}
+
+bool testMeld() {
+    sjtu::soft_heap<int> a(0.1), b(0.1);
+    for (int i = 0; i < 5000; i++) a.insert(Rand() % 100000);
+    for (int i = 0; i < 7000; i++) b.insert(Rand() % 100000);
+    a.meld(b);
+    if (!b.empty() || a.size() != 12000) return false;
+    size_t n = 0;
+    while (!a.empty()) {
+        a.pop();
+        ++n;
+    }
+    return n == 12000;
+}
+
+bool testExactWhenSmall() {
+    // with a tiny epsilon nothing gets corrupted at this size
+    sjtu::soft_heap<int> heap(1e-6);
+    std::vector<int> v;
+    for (int i = 0; i < 2000; i++) {
+        v.push_back(Rand() % 1000);
+        heap.insert(v.back());
+    }
+    std::sort(v.begin(), v.end());
+    while (!heap.empty()) {
+        if (heap.top_corrupted() || heap.top() != v.back()) return false;
+        heap.pop();
+        v.pop_back();
+    }
+    return true;
+}
+
+bool testSelect() {
+    for (int round = 0; round < 50; round++) {
+        int n = Rand() % 5000 + 1;
+        int range = round % 2 ? 10 : 1000000;
+        std::vector<int> v;
+        for (int i = 0; i < n; i++) v.push_back(Rand() % range);
+        std::vector<int> sorted(v);
+        std::sort(sorted.begin(), sorted.end());
+        int k = Rand() % n;
+        sjtu::soft_select(v.begin(), v.begin() + k, v.end());
+        if (v[k] != sorted[k]) return false;
+        for (int i = 0; i < k; i++) if (v[i] > v[k]) return false;
+        for (int i = k + 1; i < n; i++) if (v[i] < v[k]) return false;
+    }
+    return true;
+}
+
+int fail_after = -1;  // throw on the comparison after this many succeed
+
+struct FaultyCompare {
+    bool operator()(int a, int b) const {
+        if (fail_after >= 0 && fail_after-- == 0)
+            throw 1;
+        return a < b;
+    }
+};
+
+// A failed insert or meld leaves every element owned by a heap, so the
+// destructors free them all (checked under LeakSanitizer).
+bool testFailureLeaksNothing() {
+    int failures = 0;
+    for (int round = 0; round < 100; round++) {
+        sjtu::soft_heap<int, FaultyCompare> a(0.2), b(0.2);
+        for (int i = 0; i < 300; i++) {
+            a.insert(Rand() % 1000);
+            b.insert(Rand() % 1000);
+        }
+        fail_after = Rand() % 40;
+        try {
+            if (round % 2) {
+                a.meld(b);
+            } else {
+                for (int i = 0; i < 100; i++) a.insert(Rand() % 1000);
+            }
+        } catch (int) {
+            ++failures;
+        }
+        fail_after = -1;
+    }
+    return failures > 50;
+}
+
+int main() {
+    std::cout << (testCorruptionBound(0.5) ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testCorruptionBound(0.05) ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testMeld() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testExactWhenSmall() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testSelect() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testFailureLeaksNothing() ? "OKAY" : "FAIL") << std::endl;
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "heavy_hitters.hpp"
+
+int A = 325, B = 2336, last = 233, mod = 1000007;
+
+int Rand(){
+    return last = (A * last + B) % mod;
+}
+
+typedef sjtu::heavy_hitters<int> tracker;
+
+// Skewed keys: key i turns up about twice as often as key i + 1 at the head,
+// followed by a long uniform tail. Rand() repeats too soon to fill the tail,
+// so the stream has its own generator.
+unsigned long long state = 88172645463325252ull;
+
+int skewed() {
+    state ^= state << 13, state ^= state >> 7, state ^= state << 17;
+    unsigned long long r = state;
+    for (int i = 0; i < 10; i++) {
+        if (r % 2 == 0) return i;
+        r /= 2;
+    }
+    return 10 + (int)(r % 5000);
+}
+
+// Every tracked key is bracketed by its bounds; every untracked key is
+// bounded by estimate().
+bool bracketed(const tracker &t, const std::unordered_map<int, unsigned long long> &truth) {
+    for (const auto &kv : truth) {
+        unsigned long long est = t.estimate(kv.first), err = t.error(kv.first);
+        if (kv.second > est) return false;
+        if (t.contains(kv.first) && est - err > kv.second) return false;
+    }
+    return true;
+}
+
+bool testBounds() {
+    const size_t k = 50;
+    tracker t(k);
+    std::unordered_map<int, unsigned long long> truth;
+    for (int i = 0; i < 200000; i++) {
+        int key = skewed();
+        unsigned w = Rand() % 3 + 1;
+        t.update(key, w);
+        truth[key] += w;
+    }
+    if (t.size() != k || t.capacity() != k) return false;
+    unsigned long long total = 0;
+    for (const auto &kv : truth) total += kv.second;
+    if (t.total() != total || !bracketed(t, truth)) return false;
+    for (const auto &kv : truth) {
+        if (kv.second * k > total && !t.contains(kv.first)) return false;
+        if (t.contains(kv.first) && t.error(kv.first) * k > total) return false;
+    }
+    std::vector<tracker::item> top = t.top(10);
+    if (top.size() != 10) return false;
+    for (int i = 0; i < 10; i++) {
+        if (top[i].key != i || top[i].count != t.estimate(i)) return false;
+    }
+    return t.top(1000).size() == k;
+}
+
+bool testExact() {
+    sjtu::heavy_hitters<std::string> t(10);
+    const char *words[] = {"a", "b", "c", "d", "e", "f", "g", "h"};
+    for (int i = 0; i < 1000; i++) t.update(words[i % 8 * (i % 3 + 1) % 8]);
+    std::vector<sjtu::heavy_hitters<std::string>::item> top = t.top(10);
+    unsigned long long sum = 0;
+    for (size_t i = 0; i < top.size(); i++) {
+        if (top[i].error != 0) return false;
+        if (i && top[i - 1].count < top[i].count) return false;
+        sum += top[i].count;
+    }
+    if (top.size() != 8 || sum != 1000 || t.estimate("z") != 0) return false;
+    try {
+        sjtu::heavy_hitters<int> bad(0);
+        return false;
+    } catch (const sjtu::runtime_error &) {}
+    return true;
+}
+
+bool testMerge() {
+    const size_t k = 40;
+    std::vector<tracker> shards(4, tracker(k));
+    std::unordered_map<int, unsigned long long> truth;
+    for (int i = 0; i < 120000; i++) {
+        int key = skewed();
+        // Shard 3 only sees the tail, so merging it charges missing keys.
+        int s = key < 10 ? Rand() % 3 : Rand() % 4;
+        shards[s].update(key);
+        ++truth[key];
+    }
+    for (int s = 1; s < 4; s++) {
+        shards[0].merge(shards[s]);
+        if (!shards[s].empty() || shards[s].total() != 0) return false;
+    }
+    const tracker &t = shards[0];
+    if (t.total() != 120000 || t.size() != k || !bracketed(t, truth)) return false;
+    std::vector<tracker::item> top = t.top(5);
+    for (int i = 0; i < 5; i++) {
+        if (top[i].key != i) return false;
+    }
+    shards[0].merge(shards[0]);
+    return shards[0].total() == 120000;
+}
+
+int main() {
+    std::cout << (testBounds() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testExact() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testMerge() ? "OKAY" : "FAIL") << std::endl;
+    return 0;
+}
@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "execution.hpp"
+#include "priority_queue.hpp"
+
+int A = 325, B = 2336, last = 233, mod = 1000007;
+
+int Rand(){
+    return last = (A * last + B) % mod;
+}
+
+// Interleave pops with rare pushes on a frozen queue and an unfrozen copy
+// of the same elements; both must give the same tops throughout.
+template<class T, class Compare>
+bool drainMatches(const std::vector<T> &values) {
+    sjtu::priority_queue<T, Compare> frozen(values.begin(), values.end());
+    sjtu::priority_queue<T, Compare> plain(frozen);
+    frozen.freeze();
+    if (!frozen.is_frozen() || plain.is_frozen() || frozen.size() != values.size()) return false;
+    while (!plain.empty()) {
+        if (frozen.empty() || frozen.top() != plain.top()) return false;
+        if (Rand() % 20 == 0) {
+            T x = values[Rand() % values.size()];
+            frozen.push(x);
+            plain.push(x);
+        } else {
+            frozen.pop();
+            plain.pop();
+        }
+        if (frozen.size() != plain.size()) return false;
+    }
+    return frozen.empty() && !frozen.is_frozen();
+}
+
+template<class T>
+std::vector<T> randomValues(size_t n, int range) {
+    std::vector<T> values(n);
+    for (T &x : values) x = (T)(Rand() % range - range / 2);
+    return values;
+}
+
+struct Point {
+    int x, y;
+    bool operator!=(const Point &o) const { return x != o.x || y != o.y; }
+};
+
+struct PointCompare {
+    bool operator()(const Point &a, const Point &b) const {
+        return a.x != b.x ? a.x < b.x : a.y > b.y;
+    }
+};
+
+bool testDrain() {
+    std::vector<Point> points(3000);
+    for (Point &p : points) p = Point{Rand() % 50, Rand() % 50};
+    return drainMatches<int, std::less<int>>(randomValues<int>(20000, mod)) &&
+           drainMatches<int, std::greater<int>>(randomValues<int>(20000, 100)) &&
+           drainMatches<long long, std::less<long long>>(randomValues<long long>(5000, mod)) &&
+           drainMatches<short, std::greater<short>>(randomValues<short>(5000, 60000)) &&
+           drainMatches<unsigned, std::less<unsigned>>(randomValues<unsigned>(5000, mod)) &&
+           drainMatches<double, std::less<double>>(randomValues<double>(5000, mod)) &&
+           drainMatches<Point, PointCompare>(points) &&
+           drainMatches<int, std::less<int>>(std::vector<int>(1, 7));
+}
+
+bool testMergeCopyScan() {
+    std::vector<int> a = randomValues<int>(4000, mod), b = randomValues<int>(3000, mod);
+    sjtu::priority_queue<int> qa(a.begin(), a.end()), qb(b.begin(), b.end());
+    qa.freeze();
+    qb.freeze();
+    for (int i = 0; i < 100; i++) qa.pop();
+    qb.push(mod);
+    qa.merge(qb);
+    if (!qa.is_frozen() || qb.is_frozen() || !qb.empty() || qa.size() != 6901 || qa.top() != mod) return false;
+
+    sjtu::priority_queue<int> copy(qa), assigned;
+    assigned = qa;
+    long long sum = qa.reduce(0ll, [](long long s, int x) { return s + x; });
+    long long parSum = qa.reduce(sjtu::execution::par(3), 0ll, [](long long s, long long x) { return s + x; });
+    size_t odd = qa.count_if([](int x) { return x % 2 != 0; });
+    if (sum != parSum || odd != qa.count_if(sjtu::execution::par(2), [](int x) { return x % 2 != 0; })) return false;
+
+    std::vector<int> rest;
+    while (!qa.empty()) {
+        rest.push_back(qa.top());
+        qa.pop();
+    }
+    long long restSum = 0;
+    for (int x : rest) restSum += x;
+    if (restSum != sum || !std::is_sorted(rest.begin(), rest.end(), std::greater<int>())) return false;
+    for (size_t i = 0; i < rest.size(); i++) {
+        if (copy.top() != rest[i] || assigned.top() != rest[i]) return false;
+        copy.pop();
+        assigned.pop();
+    }
+    return copy.empty() && assigned.empty();
+}
+
+// Thawing and refreezing keep the elements, also after pops and pushes on
+// the frozen queue; a thawed queue is one long chain that copies and
+// deletes without recursion. A copy of a frozen queue thaws the same way.
+bool testThaw() {
+    std::vector<int> values = randomValues<int>(300000, mod);
+    sjtu::priority_queue<int> q(values.begin(), values.end());
+    q.freeze();
+    std::vector<int> popped;
+    for (int i = 0; i < 10; i++) {
+        popped.push_back(q.top());
+        q.pop();
+    }
+    for (int x : popped) q.push(x);
+    if (q.size() != values.size() || q.top() != popped[0]) return false;
+    q.push(-mod);
+    q.freeze();
+    q.freeze();
+    sjtu::priority_queue<int> frozenCopy(q);
+    frozenCopy.pop();
+    frozenCopy.thaw();
+    q.thaw();
+    q.thaw();
+    if (q.is_frozen()) return false;
+    sjtu::priority_queue<int> copy(q);
+    std::sort(values.begin(), values.end(), std::greater<int>());
+    for (size_t i = 0; i < values.size(); i++) {
+        if (copy.top() != values[i]) return false;
+        if (i > 0 && frozenCopy.top() != values[i]) return false;
+        copy.pop();
+        if (i > 0) frozenCopy.pop();
+    }
+    return frozenCopy.size() == 1 && frozenCopy.top() == -mod && copy.size() == 1 && copy.top() == -mod && q.size() == values.size() + 1;
+}
+
+int failAfter = -1;  // compares left before FaultyCompare throws; -1: never
+
+struct FaultyCompare {
+    bool operator()(int a, int b) const {
+        if (failAfter == 0) throw 1;
+        if (failAfter > 0) --failAfter;
+        return a < b;
+    }
+};
+
+bool testRollback() {
+    std::vector<int> values = randomValues<int>(2000, mod);
+    sjtu::priority_queue<int, FaultyCompare> q(values.begin(), values.end());
+    std::sort(values.begin(), values.end(), std::greater<int>());
+    failAfter = 5000;
+    try {
+        q.freeze();
+        return false;
+    } catch (const sjtu::runtime_error &) {}
+    failAfter = -1;
+    if (q.is_frozen() || q.size() != values.size()) return false;
+
+    q.freeze();
+    for (int i = 0; i < 20; i++) q.push(values[0] + 1 + i);
+    // Refreezing sorts the side heap in; a failure keeps the queue frozen.
+    failAfter = 30;
+    try {
+        q.freeze();
+        return false;
+    } catch (const sjtu::runtime_error &) {}
+    failAfter = -1;
+    if (!q.is_frozen() || q.size() != values.size() + 20) return false;
+    size_t failures = 0;
+    for (size_t i = 0; i < values.size() + 20; ) {
+        int expected = i < 20 ? values[0] + 20 - (int)i : values[i - 20];
+        if (q.top() != expected) return false;
+        failAfter = Rand() % 3;
+        try {
+            q.pop();
+            ++i;
+        } catch (const sjtu::runtime_error &) {
+            ++failures;
+        }
+        failAfter = -1;
+    }
+    return q.empty() && failures > 0;
+}
+
+int main() {
+    std::cout << (testDrain() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testMergeCopyScan() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testThaw() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testRollback() ? "OKAY" : "FAIL") << std::endl;
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <set>
+#include <vector>
+
+#include "veb_priority_queue.hpp"
+
+int A = 325, B = 2336, last = 233, mod = 1000007;
+
+int Rand(){
+    return last = (A * last + B) % mod;
+}
+
+unsigned long long state = 88172645463325252ull;
+
+uint32_t Rand32() {
+    state ^= state << 13, state ^= state >> 7, state ^= state << 17;
+    return (uint32_t)(state >> 32);
+}
+
+// Keys from a few narrow bands (many repeats, shared pages) and from the
+// whole 32-bit range (a page each), including both ends.
+uint32_t randomKey() {
+    switch (Rand() % 4) {
+        case 0: return Rand() % 200;
+        case 1: return 0xffffff00u + Rand() % 256;
+        case 2: return 0x12340000u + Rand() % 70000;
+        default: return Rand32();
+    }
+}
+
+template<class Compare>
+bool testAgainstStd() {
+    sjtu::veb_priority_queue<uint32_t, Compare> q;
+    std::priority_queue<uint32_t, std::vector<uint32_t>, Compare> ref;
+    for (int i = 0; i < 200000; i++) {
+        if (Rand() % 5 < 3 || ref.empty()) {
+            uint32_t x = randomKey();
+            q.push(x);
+            ref.push(x);
+        } else {
+            if (q.top() != ref.top()) return false;
+            q.pop();
+            ref.pop();
+        }
+        if (q.size() != ref.size()) return false;
+    }
+    while (!ref.empty()) {
+        if (q.top() != ref.top()) return false;
+        q.pop();
+        ref.pop();
+    }
+    if (!q.empty()) return false;
+    try {
+        q.pop();
+        return false;
+    } catch (const sjtu::container_is_empty &) {}
+    try {
+        q.top();
+        return false;
+    } catch (const sjtu::container_is_empty &) {}
+    return true;
+}
+
+std::vector<uint32_t> drain(sjtu::veb_priority_queue<uint32_t> q) {
+    std::vector<uint32_t> out;
+    while (!q.empty()) {
+        out.push_back(q.top());
+        q.pop();
+    }
+    return out;
+}
+
+bool testCountEraseMerge() {
+    std::vector<uint32_t> a(30000), b(20000);
+    for (uint32_t &x : a) x = randomKey();
+    for (uint32_t &x : b) x = randomKey();
+    sjtu::veb_priority_queue<uint32_t> qa(a.begin(), a.end()), qb(b.begin(), b.end()), empty;
+    std::vector<uint32_t> all(a);
+    all.insert(all.end(), b.begin(), b.end());
+
+    uint32_t probe = a[7];
+    if (qa.count(probe) != (size_t)std::count(a.begin(), a.end(), probe)) return false;
+    if (qa.count(0x7fffffffu) != (size_t)std::count(a.begin(), a.end(), 0x7fffffffu)) return false;
+
+    sjtu::veb_priority_queue<uint32_t> copy(qa), assigned;
+    assigned = qb;
+    qa.merge(qb);
+    qa.merge(empty);
+    empty.merge(qa);
+    if (!qb.empty() || !qa.empty() || empty.size() != all.size()) return false;
+    std::sort(all.begin(), all.end(), std::greater<uint32_t>());
+    if (drain(empty) != all) return false;
+
+    // Erase a scattered third of the elements, then check the rest.
+    for (size_t i = 0; i < a.size(); i += 3) {
+        if (!copy.erase(a[i])) return false;
+    }
+    std::vector<uint32_t> rest;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (i % 3) rest.push_back(a[i]);
+    }
+    std::sort(rest.begin(), rest.end(), std::greater<uint32_t>());
+    if (drain(copy) != rest || copy.count(200) != 0 || copy.erase(200) || qb.erase(1)) return false;
+    std::sort(b.begin(), b.end(), std::greater<uint32_t>());
+    return drain(assigned) == b;
+}
+
+// Erasing the top, or a repeat of it, moves top() on exactly as pops do.
+bool testEraseTop() {
+    sjtu::veb_priority_queue<uint32_t, std::greater<uint32_t>> q;
+    std::multiset<uint32_t> ref;
+    for (int i = 0; i < 50000; i++) {
+        if (Rand() % 3 || ref.empty()) {
+            uint32_t x = randomKey();
+            q.push(x);
+            ref.insert(x);
+        } else {
+            uint32_t x = Rand() % 2 ? q.top() : randomKey();
+            if (q.erase(x) != (ref.count(x) > 0)) return false;
+            if (ref.count(x)) ref.erase(ref.find(x));
+        }
+        if (q.size() != ref.size()) return false;
+        if (!ref.empty() && q.top() != *ref.begin()) return false;
+    }
+    return true;
+}
+
+int main() {
+    std::cout << (testAgainstStd<std::less<uint32_t>>() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testAgainstStd<std::greater<uint32_t>>() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testCountEraseMerge() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testEraseTop() ? "OKAY" : "FAIL") << std::endl;
+    return 0;
+}
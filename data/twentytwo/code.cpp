@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <vector>
+
+#include "weight_biased_heap.hpp"
+
+int A = 325, B = 2336, last = 233, mod = 1000007;
+
+int Rand(){
+    return last = (A * last + B) % mod;
+}
+
+int fail_after = -1;  // throw on the comparison after this many succeed
+
+struct FaultyCompare {
+    bool operator()(int a, int b) const {
+        if (fail_after >= 0 && fail_after-- == 0)
+            throw 1;
+        return a < b;
+    }
+};
+
+typedef sjtu::weight_biased_heap<int, FaultyCompare> heap;
+
+std::vector<int> drain(heap h) {
+    std::vector<int> out;
+    while (!h.empty()) {
+        out.push_back(h.top());
+        h.pop();
+    }
+    return out;
+}
+
+std::vector<int> drain(std::priority_queue<int> q) {
+    std::vector<int> out;
+    while (!q.empty()) {
+        out.push_back(q.top());
+        q.pop();
+    }
+    return out;
+}
+
+// Random pushes, pops and merges of a handful of heaps, with count_above
+// checked against a scan of the reference.
+bool testAgainstStd() {
+    heap h[4];
+    std::priority_queue<int> ref[4];
+    for (int i = 0; i < 60000; i++) {
+        int k = Rand() % 4, op = Rand() % 10;
+        if (op < 6 || ref[k].empty()) {
+            int v = Rand() % 5000;
+            h[k].push(v);
+            ref[k].push(v);
+        } else if (op < 9) {
+            if (h[k].top() != ref[k].top()) return false;
+            h[k].pop();
+            ref[k].pop();
+        } else {
+            int j = (k + 1 + Rand() % 3) % 4;
+            h[k].merge(h[j]);
+            while (!ref[j].empty()) {
+                ref[k].push(ref[j].top());
+                ref[j].pop();
+            }
+            if (!h[j].empty()) return false;
+        }
+        if (h[k].size() != ref[k].size()) return false;
+        if (i % 500 == 0) {
+            int x = Rand() % 5000;
+            std::vector<int> all = drain(ref[k]);
+            size_t above = std::count_if(all.begin(), all.end(), [x](int v) { return v > x; });
+            if (h[k].count_above(x) != above) return false;
+        }
+    }
+    for (int k = 0; k < 4; k++) {
+        if (drain(h[k]) != drain(ref[k])) return false;
+    }
+    h[0].merge(h[0]);
+    return h[0].count_above(0) == 0 || !h[0].empty();
+}
+
+// Ascending pushes build one long chain; copying, counting and destroying
+// it must not recurse.
+bool testChains() {
+    sjtu::weight_biased_heap<int> up, down;
+    for (int i = 0; i < 300000; i++) {
+        up.push(i);
+        down.push(-i);
+    }
+    sjtu::weight_biased_heap<int> copy(up), assigned;
+    assigned = down;
+    if (copy.count_above(-1) != 300000 || copy.count_above(299990) != 9) return false;
+    if (assigned.count_above(-299999) != 299999 || assigned.top() != 0) return false;
+    copy.merge(assigned);
+    if (copy.size() != 600000 || !assigned.empty()) return false;
+    for (int i = 299999; i > 299000; i--) {
+        if (copy.top() != i) return false;
+        copy.pop();
+    }
+    std::vector<int> values(200000);
+    for (int &x : values) x = Rand();
+    sjtu::weight_biased_heap<int, std::greater<int>> built(values.begin(), values.end());
+    std::sort(values.begin(), values.end());
+    for (int x : values) {
+        if (built.top() != x) return false;
+        built.pop();
+    }
+    return built.empty() && up.size() == 300000;
+}
+
+bool testRollback() {
+    heap a, b;
+    for (int i = 0; i < 3000; i++) {
+        a.push(Rand() % 10000);
+        b.push(Rand() % 10000);
+    }
+    std::vector<int> wantA = drain(a), wantB = drain(b);
+    int failures = 0;
+    for (int round = 0; round < 300; round++) {
+        fail_after = Rand() % 12;
+        try {
+            if (round % 3 == 0) {
+                a.merge(b);
+                wantA.insert(wantA.end(), wantB.begin(), wantB.end());
+                std::sort(wantA.begin(), wantA.end(), std::greater<int>());
+                wantB.clear();
+            } else if (round % 3 == 1) {
+                a.pop();
+                wantA.erase(wantA.begin());
+            } else {
+                a.push(-1);
+                wantA.push_back(-1);
+            }
+        } catch (const sjtu::runtime_error &) {
+            ++failures;
+        }
+        fail_after = -1;
+        if (a.size() != wantA.size() || b.size() != wantB.size()) return false;
+    }
+    if (drain(a) != wantA || drain(b) != wantB) return false;
+    return failures > 100;
+}
+
+int main() {
+    std::cout << (testAgainstStd() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testChains() ? "OKAY" : "FAIL") << std::endl;
+    std::cout << (testRollback() ? "OKAY" : "FAIL") << std::endl;
+    return 0;
+}
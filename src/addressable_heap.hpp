@@ -0,0 +1,488 @@
+#ifndef SJTU_ADDRESSABLE_HEAP_HPP
+#define SJTU_ADDRESSABLE_HEAP_HPP
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * A leftist heap whose nodes keep a parent pointer, so that an element can be
+ * reached again through the handle returned by push() and then erased or
+ * re-prioritised in O(log n). This is the mergeable engine shared by the
+ * keyed containers (priority_map, median_tracker, ...).
+ *
+ * Like priority_queue, top() is the largest element with respect to Compare.
+ */
+template<typename T, class Compare = std::less<T>>
+class addressable_heap {
+public:
+    class node {
+        friend class addressable_heap;
+        T data;
+        node *left;
+        node *right;
+        node *parent;
+        int dist;  // null path length for leftist heap
+
+        node(const T &val) : data(val), left(nullptr), right(nullptr), parent(nullptr), dist(0) {}
+        node(T &&val) : data(std::move(val)), left(nullptr), right(nullptr), parent(nullptr), dist(0) {}
+
+    public:
+        const T &value() const { return data; }
+    };
+
+    using handle = node *;
+
+    /**
+     * Undo log for a run of operations, possibly on several heaps, that must
+     * succeed or fail as a whole. While it is attached with track(), a heap
+     * records every link, rank and size before overwriting it, and
+     * rollback() restores them newest first. Nodes are never freed by the
+     * operations a journal can cover (merge, extract, insert), so rollback
+     * puts every node back exactly where it was.
+     */
+    class journal {
+        friend class addressable_heap;
+        struct link {
+            node **at;
+            node *was;
+        };
+        struct rank {
+            int *at;
+            int was;
+        };
+        struct count {
+            size_t *at;
+            size_t was;
+        };
+        std::vector<link> links;
+        std::vector<rank> ranks;
+        std::vector<count> counts;
+
+    public:
+        // The three kinds of fields never alias, so each list can be
+        // replayed on its own.
+        void rollback() {
+            while (!links.empty()) {
+                *links.back().at = links.back().was;
+                links.pop_back();
+            }
+            while (!ranks.empty()) {
+                *ranks.back().at = ranks.back().was;
+                ranks.pop_back();
+            }
+            while (!counts.empty()) {
+                *counts.back().at = counts.back().was;
+                counts.pop_back();
+            }
+        }
+
+        // Forget the records once the run has succeeded.
+        void clear() {
+            links.clear();
+            ranks.clear();
+            counts.clear();
+        }
+    };
+
+private:
+    node *root;
+    size_t curSize;
+    Compare cmp;
+    journal *log;  // records every write while non-null
+    journal scratch;  // update()'s own undo log, kept to reuse its memory
+
+    // Writes to the tree go through these so an attached journal sees them;
+    // the record is taken first, so a failed push_back leaves the field as
+    // it was.
+    void setLink(node *&at, node *to) {
+        if (log) log->links.push_back(typename journal::link{&at, at});
+        at = to;
+    }
+
+    void setRank(int &at, int to) {
+        if (log) log->ranks.push_back(typename journal::rank{&at, at});
+        at = to;
+    }
+
+    void setCount(size_t &at, size_t to) {
+        if (log) log->counts.push_back(typename journal::count{&at, at});
+        at = to;
+    }
+
+    void swapChildren(node *x) {
+        node *l = x->left;
+        setLink(x->left, x->right);
+        setLink(x->right, l);
+    }
+
+    static int getDist(node *x) {
+        return x ? x->dist : -1;
+    }
+
+    // Same recursion as priority_queue::mergeNodes: every comparison happens
+    // on the way down and links are only rewritten on the way back up, so a
+    // throwing Compare leaves both heaps untouched.
+    node *mergeNodes(node *h1, node *h2) {
+        if (!h1) return h2;
+        if (!h2) return h1;
+
+        if (cmp(h1->data, h2->data)) {
+            std::swap(h1, h2);
+        }
+
+        node *merged = mergeNodes(h1->right, h2);
+        setLink(h1->right, merged);
+        setLink(merged->parent, h1);
+
+        if (getDist(h1->left) < getDist(h1->right)) {
+            swapChildren(h1);
+        }
+        setRank(h1->dist, getDist(h1->right) + 1);
+
+        return h1;
+    }
+
+    // Walk up from x restoring the leftist property after one of its
+    // children has been replaced. Never compares elements, so never throws.
+    void fixUp(node *x) {
+        while (x) {
+            if (getDist(x->left) < getDist(x->right)) {
+                swapChildren(x);
+            }
+            int d = getDist(x->right) + 1;
+            if (d == x->dist) break;
+            setRank(x->dist, d);
+            x = x->parent;
+        }
+    }
+
+    // Unlink x from the tree, putting the meld of its children in its place.
+    void detach(node *x) {
+        node *sub = mergeNodes(x->left, x->right);
+        node *p = x->parent;
+        if (sub) setLink(sub->parent, p);
+        if (!p) {
+            setLink(root, sub);
+        } else {
+            setLink(p->left == x ? p->left : p->right, sub);
+            fixUp(p);
+        }
+        setLink(x->left, nullptr);
+        setLink(x->right, nullptr);
+        setLink(x->parent, nullptr);
+        setRank(x->dist, 0);
+    }
+
+    // Pre-order walk that climbs back through the parent pointers of both
+    // trees instead of recursing, so long left chains (e.g. from sorted
+    // input) cannot exhaust the stack.
+    static node *copyTree(const node *x) {
+        if (!x) return nullptr;
+
+        node *copyRoot = new node(x->data);
+        copyRoot->dist = x->dist;
+        const node *from = x;
+        node *to = copyRoot;
+        try {
+            while (true) {
+                const node *next = nullptr;
+                node **link = nullptr;
+                if (from->left && !to->left) {
+                    next = from->left;
+                    link = &to->left;
+                } else if (from->right && !to->right) {
+                    next = from->right;
+                    link = &to->right;
+                }
+                if (next) {
+                    *link = new node(next->data);
+                    (*link)->parent = to;
+                    (*link)->dist = next->dist;
+                    from = next;
+                    to = *link;
+                } else if (from == x) {
+                    break;
+                } else {
+                    from = from->parent;
+                    to = to->parent;
+                }
+            }
+        } catch (...) {
+            deleteTree(copyRoot);
+            throw;
+        }
+        return copyRoot;
+    }
+
+    // Rotates left children onto the right spine instead of recursing, so
+    // long left chains (e.g. from sorted input) cannot exhaust the stack.
+    static void deleteTree(node *x) {
+        while (x) {
+            if (x->left) {
+                node *l = x->left;
+                x->left = l->right;
+                l->right = x;
+                x = l;
+            } else {
+                node *r = x->right;
+                delete x;
+                x = r;
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief default constructor
+     */
+    addressable_heap() : root(nullptr), curSize(0), cmp(), log(nullptr) {}
+
+    explicit addressable_heap(const Compare &c) : root(nullptr), curSize(0), cmp(c), log(nullptr) {}
+
+    /**
+     * @brief copy constructor. Handles into other are not valid for the copy.
+     */
+    addressable_heap(const addressable_heap &other)
+        : root(nullptr), curSize(other.curSize), cmp(other.cmp), log(nullptr) {
+        root = copyTree(other.root);
+    }
+
+    ~addressable_heap() {
+        deleteTree(root);
+    }
+
+    addressable_heap &operator=(const addressable_heap &other) {
+        if (this == &other) return *this;
+
+        node *newRoot = copyTree(other.root);
+        deleteTree(root);
+        root = newRoot;
+        curSize = other.curSize;
+        cmp = other.cmp;
+
+        return *this;
+    }
+
+    /**
+     * @brief get the top element.
+     * @throws container_is_empty if empty() returns true
+     */
+    const T &top() const {
+        if (empty()) {
+            throw container_is_empty();
+        }
+        return root->data;
+    }
+
+    /**
+     * @brief handle of the top element.
+     * @throws container_is_empty if empty() returns true
+     */
+    handle top_handle() const {
+        if (empty()) {
+            throw container_is_empty();
+        }
+        return root;
+    }
+
+    /**
+     * @brief push a new element.
+     * @return a handle that stays valid until the element is erased or popped.
+     * @throws runtime_error if Compare throws; the heap is unchanged.
+     */
+    handle push(const T &e) {
+        node *newNode = new node(e);
+        try {
+            insert(newNode);
+        } catch (...) {
+            delete newNode;
+            throw;
+        }
+        return newNode;
+    }
+
+    handle push(T &&e) {
+        node *newNode = new node(std::move(e));
+        try {
+            insert(newNode);
+        } catch (...) {
+            delete newNode;
+            throw;
+        }
+        return newNode;
+    }
+
+    /**
+     * @brief delete the top element.
+     * @throws container_is_empty if empty() returns true
+     * @throws runtime_error if Compare throws; the heap is unchanged.
+     */
+    void pop() {
+        delete extract(top_handle());
+    }
+
+    /**
+     * @brief delete the element behind h in O(log n).
+     * @throws runtime_error if Compare throws; the heap is unchanged.
+     */
+    void erase(handle h) {
+        delete extract(h);
+    }
+
+    /**
+     * @brief replace the element behind h and restore heap order in
+     * O(log n). The unlink and relink run under a journal, and the new
+     * element is swapped in, so a failure puts both back.
+     * Not for use while a journal is attached with track().
+     * @throws runtime_error if Compare throws; the heap is unchanged and h
+     * still holds its old element.
+     */
+    void update(handle h, const T &e) {
+        T next(e);
+        bool swapped = false;
+        log = &scratch;
+        try {
+            extract(h);
+            std::swap(h->data, next);
+            swapped = true;
+            insert(h);
+        } catch (...) {
+            log = nullptr;
+            scratch.rollback();
+            if (swapped) std::swap(h->data, next);
+            throw runtime_error();
+        }
+        log = nullptr;
+        scratch.clear();
+    }
+
+    /**
+     * @brief unlink the element behind h without freeing it. The detached
+     * node can later be handed to insert() of this or another heap, which
+     * keeps the handle valid.
+     * @throws runtime_error if Compare throws; the heap is unchanged.
+     */
+    handle extract(handle h) {
+        try {
+            detach(h);
+        } catch (...) {
+            throw runtime_error();
+        }
+        setCount(curSize, curSize - 1);
+        return h;
+    }
+
+    /**
+     * @brief a detached node holding e, owned by the caller until it is
+     * handed to insert(). Lets a caller that journals the insert free the
+     * node only after rolling back.
+     */
+    static handle make_handle(const T &e) {
+        return new node(e);
+    }
+
+    /**
+     * @brief adopt a node previously returned by extract() or make_handle().
+     * @throws runtime_error if Compare throws; the heap is unchanged and the
+     * node is still owned by the caller.
+     */
+    void insert(handle h) {
+        node *newRoot;
+        try {
+            newRoot = mergeNodes(root, h);
+            setLink(root, newRoot);
+            setLink(root->parent, nullptr);
+            setCount(curSize, curSize + 1);
+        } catch (...) {
+            throw runtime_error();
+        }
+    }
+
+    size_t size() const {
+        return curSize;
+    }
+
+    bool empty() const {
+        return curSize == 0;
+    }
+
+    /**
+     * @brief meld other into this heap in O(log n). Handles into other stay
+     * valid and now refer to elements of this heap.
+     * @throws runtime_error if Compare throws; both heaps are unchanged.
+     */
+    void merge(addressable_heap &other) {
+        if (this == &other) return;
+
+        try {
+            node *newRoot = mergeNodes(root, other.root);
+            setLink(root, newRoot);
+            if (root) setLink(root->parent, nullptr);
+            setCount(curSize, curSize + other.curSize);
+            setLink(other.root, nullptr);
+            setCount(other.curSize, 0);
+        } catch (...) {
+            throw runtime_error();
+        }
+    }
+
+    /**
+     * @brief exchange contents with other; handles follow their elements.
+     */
+    void swap(addressable_heap &other) {
+        std::swap(root, other.root);
+        std::swap(curSize, other.curSize);
+        std::swap(cmp, other.cmp);
+    }
+
+    /**
+     * @brief visit every handle in unspecified order.
+     */
+    template<class F>
+    void for_each_handle(F f) const {
+        visitHandles(root, f);
+    }
+
+    /**
+     * @brief record every later change in j (nullptr stops recording).
+     * Use it around merge, extract and insert only: the other operations
+     * free nodes, which a rollback could not bring back.
+     */
+    void track(journal *j) {
+        log = j;
+    }
+
+    /**
+     * @brief a copy of the comparison object.
+     */
+    Compare value_comp() const {
+        return cmp;
+    }
+
+private:
+    // Pre-order walk climbing through parent pointers, so it needs no stack
+    // however the tree is shaped.
+    template<class F>
+    static void visitHandles(node *x, F &f) {
+        while (x) {
+            f(x);
+            if (x->left) {
+                x = x->left;
+            } else if (x->right) {
+                x = x->right;
+            } else {
+                while (x->parent && (x->parent->right == x || !x->parent->right)) x = x->parent;
+                x = x->parent ? x->parent->right : nullptr;
+            }
+        }
+    }
+};
+
+}
+
+#endif
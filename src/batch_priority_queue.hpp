@@ -0,0 +1,266 @@
+#ifndef SJTU_BATCH_PRIORITY_QUEUE_HPP
+#define SJTU_BATCH_PRIORITY_QUEUE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <vector>
+#include "exceptions.hpp"
+#include "execution.hpp"
+#include "priority_queue.hpp"
+
+namespace sjtu {
+
+/**
+ * A priority queue for bulk-synchronous rounds: every round inserts a batch
+ * and removes the k best elements, both spread over threads. The elements
+ * live in a fixed number of shards, each a leftist priority_queue owned by
+ * one thread during a batch operation, so no locks are taken.
+ *
+ * - insert_batch builds one leftist heap per shard from its slice of the
+ *   batch in O(n / shards) and melds it into the shard in O(log n).
+ * - delete_top_k is exact: every shard pops a share of k in parallel into a
+ *   sorted candidate list, the lists are merged k-way, and a shard whose
+ *   list runs out while it may still hold better elements is refilled with
+ *   twice its previous share before the merge goes on. Candidates are
+ *   detached nodes rather than copies, and those that were not selected are
+ *   linked back on top of their shards without allocating or comparing, so
+ *   neither a throwing Compare nor a failed allocation loses elements.
+ *
+ * Like priority_queue, the best element is the largest with respect to
+ * Compare.
+ */
+template<typename T, class Compare = std::less<T>>
+class batch_priority_queue {
+private:
+    using shard_type = priority_queue<T, Compare>;
+    using node_type = typename shard_type::Node;
+
+    std::vector<shard_type> shards;
+    size_t curSize;
+    Compare cmp;
+
+    // Run f(i) for every shard, splitting the shards in halves through
+    // log2(concurrency()) levels of fork_join.
+    template<class Policy, class F>
+    static void forShards(const Policy &policy, size_t lo, size_t hi, unsigned depth, F &f) {
+        if (depth == 0 || hi - lo < 2) {
+            for (size_t i = lo; i < hi; ++i) f(i);
+            return;
+        }
+        size_t mid = lo + (hi - lo) / 2;
+        policy.fork_join([&]() { forShards(policy, lo, mid, depth - 1, f); },
+                         [&]() { forShards(policy, mid, hi, depth - 1, f); });
+    }
+
+    template<class Policy, class F>
+    void forShards(const Policy &policy, F f) {
+        unsigned depth = 0;
+        while ((1u << depth) < policy.concurrency()) ++depth;
+        forShards(policy, 0, shards.size(), depth, f);
+    }
+
+    // Link every candidate list from index taken[i] on back on top of shard
+    // i. The candidates are the nodes last detached from their shard, best
+    // first, so this cannot fail.
+    void restore(std::vector<std::vector<node_type *>> &candidates, const std::vector<size_t> &taken) {
+        for (size_t i = 0; i < shards.size(); ++i) {
+            shards[i].restoreTop(candidates[i].data() + taken[i], candidates[i].size() - taken[i]);
+        }
+    }
+
+    // Free the selected candidates, candidates[i][0, taken[i]).
+    static void release(std::vector<std::vector<node_type *>> &candidates, const std::vector<size_t> &taken) {
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            for (size_t j = 0; j < taken[i]; ++j) delete candidates[i][j];
+        }
+    }
+
+public:
+    /**
+     * @param shardCount number of shards, normally the number of threads
+     * that will work on the queue; 0 means one per hardware thread.
+     */
+    explicit batch_priority_queue(unsigned shardCount = 0) : shards(), curSize(0), cmp() {
+        if (shardCount == 0) shardCount = execution::par.concurrency();
+        shards.resize(shardCount);
+    }
+
+    /**
+     * @throws container_is_empty if empty() returns true
+     * @throws runtime_error if Compare throws
+     */
+    const T &top() const {
+        if (empty()) {
+            throw container_is_empty();
+        }
+        const T *best = nullptr;
+        try {
+            for (const shard_type &shard : shards) {
+                if (!shard.empty() && (!best || cmp(*best, shard.top()))) best = &shard.top();
+            }
+        } catch (...) {
+            throw runtime_error();
+        }
+        return *best;
+    }
+
+    /**
+     * @brief insert one element into the smallest shard.
+     * @throws runtime_error if Compare throws; the queue is unchanged.
+     */
+    void push(const T &e) {
+        size_t smallest = 0;
+        for (size_t i = 1; i < shards.size(); ++i) {
+            if (shards[i].size() < shards[smallest].size()) smallest = i;
+        }
+        shards[smallest].push(e);
+        ++curSize;
+    }
+
+    /**
+     * @brief insert [first, last), split evenly over the shards and built
+     * and melded on the threads of policy (see execution.hpp).
+     * @throws runtime_error if Compare throws. If it throws while building,
+     * nothing is inserted; if it throws while melding, the slices of the
+     * shards that were already melded stay inserted.
+     */
+    template<class Policy, class RandomIt,
+             class = typename std::decay<Policy>::type::execution_policy_tag>
+    void insert_batch(Policy &&policy, RandomIt first, RandomIt last) {
+        size_t n = last - first, s = shards.size();
+        std::vector<shard_type> parts(s);
+        forShards(policy, [&](size_t i) {
+            shard_type part(first + n * i / s, first + n * (i + 1) / s);
+            parts[i].merge(part);
+        });
+        std::vector<unsigned char> melded(s, 0);
+        try {
+            forShards(policy, [&](size_t i) {
+                shards[i].merge(parts[i]);
+                melded[i] = 1;
+            });
+        } catch (...) {
+            for (size_t i = 0; i < s; ++i) {
+                if (melded[i]) curSize += n * (i + 1) / s - n * i / s;
+            }
+            throw;
+        }
+        curSize += n;
+    }
+
+    template<class RandomIt>
+    void insert_batch(RandomIt first, RandomIt last) {
+        insert_batch(execution::seq, first, last);
+    }
+
+    /**
+     * @brief remove the min(k, size()) best elements and write them to out
+     * from best to worst, popping the shards on the threads of policy.
+     * @return the output iterator past the last element written
+     * @throws runtime_error if Compare throws; nothing is written to out and
+     * the queue is unchanged.
+     */
+    template<class Policy, class OutputIt,
+             class = typename std::decay<Policy>::type::execution_policy_tag>
+    OutputIt delete_top_k(Policy &&policy, size_t k, OutputIt out) {
+        if (k > curSize) k = curSize;
+        if (k == 0) return out;
+
+        size_t s = shards.size();
+        std::vector<std::vector<node_type *>> candidates(s);
+        std::vector<size_t> taken(s, 0), quota(s, 0);
+        std::vector<unsigned> order;  // shard of each selected element
+        order.reserve(k);
+        // Expected share plus slack, so that most rounds need no refill.
+        size_t share = k / s + k / (4 * s) + 8;
+        for (size_t i = 0; i < s; ++i) quota[i] = share < k ? share : k;
+
+        auto headLess = [&](unsigned a, unsigned b) {
+            return cmp(candidates[a][taken[a]]->data, candidates[b][taken[b]]->data);
+        };
+        try {
+            std::vector<unsigned> heads;
+            while (true) {
+                // Pop the pending quotas into the candidate lists.
+                forShards(policy, [&](size_t i) {
+                    for (; quota[i] > 0 && !shards[i].empty(); --quota[i]) {
+                        candidates[i].push_back(nullptr);
+                        try {
+                            candidates[i].back() = shards[i].detachTop();
+                        } catch (...) {
+                            candidates[i].pop_back();
+                            throw;
+                        }
+                    }
+                    quota[i] = 0;
+                });
+                for (size_t i = 0; i < s; ++i) {
+                    if (taken[i] < candidates[i].size() &&
+                        std::find(heads.begin(), heads.end(), (unsigned)i) == heads.end()) {
+                        heads.push_back((unsigned)i);
+                        std::push_heap(heads.begin(), heads.end(), headLess);
+                    }
+                }
+                // Merge until k are selected or a shard that may still hold
+                // better elements has no candidates left.
+                bool blocked = false;
+                while (order.size() < k && !heads.empty() && !blocked) {
+                    std::pop_heap(heads.begin(), heads.end(), headLess);
+                    unsigned i = heads.back();
+                    order.push_back(i);
+                    if (++taken[i] < candidates[i].size()) {
+                        std::push_heap(heads.begin(), heads.end(), headLess);
+                    } else {
+                        heads.pop_back();
+                        if (!shards[i].empty()) {
+                            size_t want = k - order.size();
+                            size_t more = 2 * candidates[i].size();
+                            quota[i] = more < want ? more : want;
+                            blocked = quota[i] > 0;
+                        }
+                    }
+                }
+                if (!blocked) break;
+            }
+        } catch (...) {
+            for (size_t i = 0; i < s; ++i) taken[i] = 0;
+            restore(candidates, taken);
+            throw runtime_error();
+        }
+
+        restore(candidates, taken);
+        curSize -= k;
+        std::vector<size_t> next(s, 0);
+        try {
+            for (unsigned i : order) *out++ = candidates[i][next[i]++]->data;
+        } catch (...) {
+            release(candidates, taken);
+            throw;
+        }
+        release(candidates, taken);
+        return out;
+    }
+
+    template<class OutputIt>
+    OutputIt delete_top_k(size_t k, OutputIt out) {
+        return delete_top_k(execution::seq, k, out);
+    }
+
+    size_t size() const {
+        return curSize;
+    }
+
+    bool empty() const {
+        return curSize == 0;
+    }
+
+    size_t shard_count() const {
+        return shards.size();
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,358 @@
+#ifndef SJTU_COMPRESSED_PRIORITY_QUEUE_HPP
+#define SJTU_COMPRESSED_PRIORITY_QUEUE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <vector>
+#include "exceptions.hpp"
+#include "priority_queue.hpp"
+
+namespace sjtu {
+
+/**
+ * A max priority queue of unsigned integers for very large, drain-heavy
+ * workloads. New keys go to a small hot priority_queue. When that reaches
+ * hotLimit elements it is drained into a sorted run, which is stored
+ * compressed as varint-encoded deltas. A run is decoded one block at a time,
+ * and only when its head is needed to order it against the others.
+ *
+ * Runs of similar size are merged (size-tiered), so there are O(log n) of
+ * them and each key is re-encoded O(log n) times; merge() re-tiers the
+ * combined runs to keep it so. If an allocation fails while a run is
+ * written, the keys stay where they were. Sorted 64-bit keys usually
+ * take 1-6 bytes each, against 32 bytes for a priority_queue node. A pop
+ * costs one block decode every blockSize elements plus O(log runs) to
+ * re-order the runs.
+ */
+template<typename UInt = unsigned long long>
+class compressed_priority_queue {
+    static_assert(std::is_integral<UInt>::value && std::is_unsigned<UInt>::value,
+                  "compressed_priority_queue stores unsigned integers");
+
+private:
+    static constexpr size_t blockSize = 128;
+
+    // How far a run has been read. Decoding never touches the bytes, so
+    // saving this is enough to undo a failed merge's reads.
+    struct ReadState {
+        size_t remaining;   // keys not popped yet, head included
+        size_t undecoded;   // keys still only in bytes
+        size_t pos;         // next byte to decode
+        UInt block[blockSize];
+        size_t blockLen;
+        size_t blockIdx;
+
+        ReadState() : remaining(0), undecoded(0), pos(0), blockLen(0), blockIdx(0) {}
+    };
+
+    // A descending run: each block holds its first key verbatim, then the
+    // difference to the previous key, all as LEB128 varints.
+    struct Run : ReadState {
+        std::vector<unsigned char> bytes;
+
+        Run() : ReadState(), bytes() {}
+
+        UInt head() const {
+            return this->block[this->blockIdx];
+        }
+
+        UInt readVarint() {
+            UInt v = 0;
+            unsigned shift = 0;
+            unsigned char byte;
+            do {
+                byte = bytes[this->pos++];
+                v |= (UInt)(byte & 0x7f) << shift;
+                shift += 7;
+            } while (byte & 0x80);
+            return v;
+        }
+
+        void decodeBlock() {
+            this->blockLen = this->undecoded < blockSize ? this->undecoded : blockSize;
+            this->blockIdx = 0;
+            this->block[0] = readVarint();
+            for (size_t i = 1; i < this->blockLen; ++i) this->block[i] = this->block[i - 1] - readVarint();
+            this->undecoded -= this->blockLen;
+        }
+
+        // Drop the head. @return false once the run is exhausted
+        bool advance() {
+            --this->remaining;
+            if (this->remaining == 0) return false;
+            if (++this->blockIdx == this->blockLen) decodeBlock();
+            return true;
+        }
+    };
+
+    // Encodes a descending key sequence into a Run.
+    class RunWriter {
+        Run *run;
+        UInt prev;
+        size_t inBlock;
+
+        void writeVarint(UInt v) {
+            while (v >= 0x80) {
+                run->bytes.push_back((unsigned char)(v | 0x80));
+                v >>= 7;
+            }
+            run->bytes.push_back((unsigned char)v);
+        }
+
+    public:
+        explicit RunWriter(Run *r) : run(r), prev(0), inBlock(0) {}
+
+        void append(UInt v) {
+            writeVarint(inBlock == 0 ? v : prev - v);
+            prev = v;
+            inBlock = (inBlock + 1) % blockSize;
+            ++run->remaining;
+            ++run->undecoded;
+        }
+
+        void finish() {
+            run->bytes.shrink_to_fit();
+            if (run->remaining) run->decodeBlock();
+        }
+    };
+
+    struct headLess {
+        bool operator()(const Run *a, const Run *b) const {
+            return a->head() < b->head();
+        }
+    };
+
+    priority_queue<UInt> hot;
+    size_t hotLimit;
+    std::vector<Run *> runs;   // creation order, for size-tiered merging
+    std::vector<Run *> heads;  // max-heap of runs by head()
+    size_t coldSize;
+
+    void rebuildHeads() {
+        heads = runs;
+        std::make_heap(heads.begin(), heads.end(), headLess());
+    }
+
+    // Merge two runs into a new one. If that fails, a and b are read from
+    // where they were again.
+    Run *mergeRuns(Run *a, Run *b) {
+        ReadState savedA = *a, savedB = *b;
+        Run *merged = new Run();
+        try {
+            RunWriter writer(merged);
+            bool hasA = true, hasB = true;
+            while (hasA || hasB) {
+                if (hasA && (!hasB || a->head() >= b->head())) {
+                    writer.append(a->head());
+                    hasA = a->advance();
+                } else {
+                    writer.append(b->head());
+                    hasB = b->advance();
+                }
+            }
+            writer.finish();
+        } catch (...) {
+            delete merged;
+            static_cast<ReadState &>(*a) = savedA;
+            static_cast<ReadState &>(*b) = savedB;
+            throw;
+        }
+        return merged;
+    }
+
+    // Room for n runs in both lists, so that rebuildHeads() cannot throw.
+    void reserveRuns(size_t n) {
+        runs.reserve(n);
+        heads.reserve(n);
+    }
+
+    // Merge each run into the one before it while that one is not much
+    // larger, given that runs[0, tiered) already satisfy this. A failed
+    // merge leaves both of its runs intact, so the failure path only has
+    // to close the gap left by the runs merged so far.
+    void tier(size_t tiered) {
+        size_t n = tiered, i = tiered;
+        try {
+            for (; i < runs.size(); ++i) {
+                runs[n++] = runs[i];
+                while (n >= 2 && runs[n - 2]->remaining <= 2 * runs[n - 1]->remaining) {
+                    Run *merged = mergeRuns(runs[n - 2], runs[n - 1]);
+                    delete runs[n - 2];
+                    delete runs[n - 1];
+                    runs[n - 2] = merged;
+                    --n;
+                }
+            }
+        } catch (...) {
+            runs.erase(runs.begin() + n, runs.begin() + i + 1);
+            rebuildHeads();
+            throw;
+        }
+        runs.resize(n);
+        rebuildHeads();
+    }
+
+    // Compress the hot buffer into a new run. The run is written from a
+    // sorted copy of the keys, and the buffer is only emptied once it is
+    // complete.
+    void flush() {
+        reserveRuns(runs.size() + 1);
+        std::vector<UInt> keys;
+        keys.reserve(hot.size());
+        hot.for_each([&keys](const UInt &x) { keys.push_back(x); });
+        std::sort(keys.begin(), keys.end(), std::greater<UInt>());
+
+        Run *run = new Run();
+        try {
+            RunWriter writer(run);
+            for (size_t i = 0; i < keys.size(); ++i) writer.append(keys[i]);
+            writer.finish();
+        } catch (...) {
+            delete run;
+            throw;
+        }
+        hot = priority_queue<UInt>();
+        runs.push_back(run);
+        coldSize += run->remaining;
+        tier(runs.size() - 1);
+    }
+
+    void clearRuns() {
+        for (Run *run : runs) delete run;
+        runs.clear();
+        heads.clear();
+        coldSize = 0;
+    }
+
+public:
+    /**
+     * @param hotLimit how many keys the hot buffer holds before it is
+     * compressed into a run
+     */
+    explicit compressed_priority_queue(size_t hotLimit = 65536)
+        : hot(), hotLimit(hotLimit ? hotLimit : 1), runs(), heads(), coldSize(0) {}
+
+    compressed_priority_queue(const compressed_priority_queue &other)
+        : hot(other.hot), hotLimit(other.hotLimit), runs(), heads(), coldSize(other.coldSize) {
+        try {
+            for (Run *run : other.runs) {
+                runs.push_back(nullptr);
+                runs.back() = new Run(*run);
+            }
+        } catch (...) {
+            clearRuns();
+            throw;
+        }
+        rebuildHeads();
+    }
+
+    ~compressed_priority_queue() {
+        clearRuns();
+    }
+
+    compressed_priority_queue &operator=(const compressed_priority_queue &other) {
+        if (this == &other) return *this;
+
+        compressed_priority_queue tmp(other);
+        hot = tmp.hot;
+        hotLimit = tmp.hotLimit;
+        runs.swap(tmp.runs);
+        heads.swap(tmp.heads);
+        std::swap(coldSize, tmp.coldSize);
+        return *this;
+    }
+
+    /**
+     * @throws container_is_empty if empty() returns true
+     */
+    const UInt &top() const {
+        if (empty()) {
+            throw container_is_empty();
+        }
+        if (heads.empty()) return hot.top();
+        const Run *best = heads.front();
+        if (!hot.empty() && hot.top() > best->head()) return hot.top();
+        return best->block[best->blockIdx];
+    }
+
+    void push(const UInt &e) {
+        hot.push(e);
+        if (hot.size() >= hotLimit) flush();
+    }
+
+    /**
+     * @throws container_is_empty if empty() returns true
+     */
+    void pop() {
+        if (empty()) {
+            throw container_is_empty();
+        }
+        if (heads.empty() || (!hot.empty() && hot.top() > heads.front()->head())) {
+            hot.pop();
+            return;
+        }
+
+        std::pop_heap(heads.begin(), heads.end(), headLess());
+        Run *run = heads.back();
+        --coldSize;
+        if (run->advance()) {
+            std::push_heap(heads.begin(), heads.end(), headLess());
+        } else {
+            heads.pop_back();
+            runs.erase(std::find(runs.begin(), runs.end(), run));
+            delete run;
+        }
+    }
+
+    size_t size() const {
+        return hot.size() + coldSize;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief move every key of other into this queue; other is cleared.
+     * O(log n) for the hot buffers. The combined runs are then re-tiered,
+     * largest first, which re-encodes the keys of the runs it merges, like
+     * the merges flushing would have done had the keys arrived here.
+     */
+    void merge(compressed_priority_queue &other) {
+        if (this == &other) return;
+
+        reserveRuns(runs.size() + other.runs.size() + 1);
+        hot.merge(other.hot);
+        runs.insert(runs.end(), other.runs.begin(), other.runs.end());
+        coldSize += other.coldSize;
+        other.runs.clear();
+        other.heads.clear();
+        other.coldSize = 0;
+        std::sort(runs.begin(), runs.end(), [](const Run *a, const Run *b) { return a->remaining > b->remaining; });
+        tier(0);
+        if (hot.size() >= hotLimit) flush();
+    }
+
+    /**
+     * @brief bytes held by the compressed runs, including decoded blocks.
+     */
+    size_t cold_bytes() const {
+        size_t bytes = 0;
+        for (const Run *run : runs) bytes += sizeof(Run) + run->bytes.capacity();
+        return bytes;
+    }
+
+    size_t hot_size() const {
+        return hot.size();
+    }
+
+    size_t run_count() const {
+        return runs.size();
+    }
+};
+
+}
+
+#endif
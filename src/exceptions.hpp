@@ -2,37 +2,72 @@
 #define SJTU_EXCEPTIONS_HPP
 
 #include <cstddef>
-#include <cstring>
 #include <string>
 
 namespace sjtu {
 
+enum class error_code : unsigned char {
+	generic,
+	index_out_of_bound,
+	runtime_error,
+	invalid_iterator,
+	container_is_empty
+};
+
 class exception {
 protected:
-	const std::string variant = "";
-	std::string detail = "";
+	// The code is all an exception carries and its name lives in static
+	// storage, so constructing, copying and throwing an exception never
+	// allocates.
+	error_code code_ = error_code::generic;
+
+	explicit exception(error_code c) noexcept : code_(c) {}
 public:
-	exception() {}
-	exception(const exception &ec) : variant(ec.variant), detail(ec.detail) {}
+	exception() noexcept {}
+	exception(const exception &ec) noexcept = default;
+	virtual ~exception() = default;
+
+	error_code code() const noexcept {
+		return code_;
+	}
+
+	const char *name() const noexcept {
+		static const char *const names[] = {
+			"exception",
+			"index_out_of_bound",
+			"runtime_error",
+			"invalid_iterator",
+			"container_is_empty"
+		};
+		return names[static_cast<unsigned char>(code_)];
+	}
+
+	// Same signature and text as ever: the variant and detail it used to
+	// join were always empty. A one-character string fits in the string's
+	// own buffer, so this does not allocate either.
 	virtual std::string what() {
-		return variant + " " + detail;
+		return std::string(" ");
 	}
 };
 
 class index_out_of_bound : public exception {
-	/* __________________________ */
+public:
+	index_out_of_bound() noexcept : exception(error_code::index_out_of_bound) {}
 };
 
 class runtime_error : public exception {
-	/* __________________________ */
+public:
+	runtime_error() noexcept : exception(error_code::runtime_error) {}
 };
 
 class invalid_iterator : public exception {
-	/* __________________________ */
+public:
+	invalid_iterator() noexcept : exception(error_code::invalid_iterator) {}
 };
 
 class container_is_empty : public exception {
-	/* __________________________ */
+public:
+	container_is_empty() noexcept : exception(error_code::container_is_empty) {}
 };
 }
 
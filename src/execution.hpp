@@ -0,0 +1,80 @@
+#ifndef SJTU_EXECUTION_HPP
+#define SJTU_EXECUTION_HPP
+
+#include <cstddef>
+#include <exception>
+#include <thread>
+
+namespace sjtu {
+namespace execution {
+
+/**
+ * Execution policies accepted by the parallel overloads of the containers.
+ * A policy only has to provide
+ *  - concurrency(): how many threads it may use, and
+ *  - fork_join(f, g): run f() and g(), possibly in parallel, and return once
+ *    both have finished, rethrowing the first exception either one threw.
+ * The containers split their work recursively into log2(concurrency())
+ * levels of fork_join, so they never include <thread> themselves.
+ */
+struct sequenced_policy {
+    using execution_policy_tag = void;
+
+    unsigned concurrency() const {
+        return 1;
+    }
+
+    template<class F, class G>
+    void fork_join(F &&f, G &&g) const {
+        f();
+        g();
+    }
+};
+
+struct parallel_policy {
+    using execution_policy_tag = void;
+
+    unsigned threads;  // 0: one per hardware thread
+
+    unsigned concurrency() const {
+        if (threads) return threads;
+        unsigned hw = std::thread::hardware_concurrency();
+        return hw ? hw : 1;
+    }
+
+    /**
+     * @brief a policy using exactly n threads.
+     */
+    parallel_policy operator()(unsigned n) const {
+        return parallel_policy{n};
+    }
+
+    // f runs on a new thread, g on the calling one.
+    template<class F, class G>
+    void fork_join(F &&f, G &&g) const {
+        std::exception_ptr error;
+        std::thread worker([&f, &error]() {
+            try {
+                f();
+            } catch (...) {
+                error = std::current_exception();
+            }
+        });
+        try {
+            g();
+        } catch (...) {
+            worker.join();
+            throw;
+        }
+        worker.join();
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+constexpr sequenced_policy seq{};
+constexpr parallel_policy par{0};
+
+}
+}
+
+#endif
@@ -0,0 +1,359 @@
+#ifndef SJTU_EXPIRING_QUEUE_HPP
+#define SJTU_EXPIRING_QUEUE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "exceptions.hpp"
+#include "leftist_tree.hpp"
+
+namespace sjtu {
+
+/**
+ * A priority queue whose elements carry an expiry time. Expired elements
+ * never show up in top().
+ *
+ * Next to the leftist heap, every live element sits in one bucket of a hashed
+ * timing wheel indexed by its expiry. advance_time() walks only the buckets
+ * between the old and the new time and turns their due elements into
+ * tombstones in bulk; the heap itself is not touched. Tombstones are dropped
+ * when they surface at the root, and the heap is rebuilt from the live nodes
+ * once tombstones outnumber them.
+ */
+template<typename T, class Compare = std::less<T>>
+class expiring_queue {
+public:
+    using time_type = unsigned long long;
+
+private:
+    struct Node {
+        T data;
+        Node *left;
+        Node *right;
+        int dist;  // null path length for leftist heap
+        time_type expiry;
+        Node *prevInBucket;
+        Node *nextInBucket;
+        bool expired;  // tombstone: still in the heap, no longer in the wheel
+
+        Node(const T &val, time_type exp)
+            : data(val), left(nullptr), right(nullptr), dist(0), expiry(exp),
+              prevInBucket(nullptr), nextInBucket(nullptr), expired(false) {}
+    };
+
+    Node *root;
+    size_t liveSize;
+    size_t deadSize;
+    Compare cmp;
+
+    Node **wheel;
+    size_t wheelSize;  // power of two
+    time_type granularity;
+    time_type current;
+
+    using tree = leftist_tree<Node>;
+
+    struct nodeBefore {
+        Compare &cmp;
+        bool operator()(const Node *a, const Node *b) const {
+            return cmp(a->data, b->data);
+        }
+    };
+
+    Node *mergeNodes(Node *h1, Node *h2) {
+        return tree::merge(h1, h2, nodeBefore{cmp});
+    }
+
+    size_t slotOf(time_type expiry) const {
+        return (expiry / granularity) & (wheelSize - 1);
+    }
+
+    void linkBucket(Node *node) {
+        Node *&head = wheel[slotOf(node->expiry)];
+        node->prevInBucket = nullptr;
+        node->nextInBucket = head;
+        if (head) head->prevInBucket = node;
+        head = node;
+    }
+
+    void unlinkBucket(Node *node) {
+        if (node->prevInBucket) node->prevInBucket->nextInBucket = node->nextInBucket;
+        else wheel[slotOf(node->expiry)] = node->nextInBucket;
+        if (node->nextInBucket) node->nextInBucket->prevInBucket = node->prevInBucket;
+        node->prevInBucket = node->nextInBucket = nullptr;
+    }
+
+    // Tombstone every element of one bucket that is due at time t. Elements
+    // hashed into the same bucket from a later wheel rotation stay.
+    size_t expireBucket(size_t slot, time_type t) {
+        size_t count = 0;
+        Node *node = wheel[slot];
+        while (node) {
+            Node *next = node->nextInBucket;
+            if (node->expiry <= t) {
+                unlinkBucket(node);
+                node->expired = true;
+                ++count;
+            }
+            node = next;
+        }
+        return count;
+    }
+
+    // Drop tombstones sitting at the root so that top() is always live.
+    void purgeRoot() {
+        while (root && root->expired) {
+            Node *newRoot = mergeNodes(root->left, root->right);
+            delete root;
+            root = newRoot;
+            --deadSize;
+        }
+    }
+
+    // Rebuild the heap from its live nodes by pairwise melding (O(n)). The
+    // old links are journaled first so that a throwing Compare can put the
+    // tree back exactly as it was.
+    void compact() {
+        struct saved {
+            Node *node;
+            Node *left;
+            Node *right;
+            int dist;
+        };
+        std::vector<saved> journal;
+        std::vector<Node *> queue;
+        journal.reserve(liveSize + deadSize);
+        queue.reserve(2 * liveSize);
+        tree::visit(root, [&journal](Node *x) {
+            journal.push_back(saved{x, x->left, x->right, x->dist});
+        });
+
+        Node *oldRoot = root;
+        try {
+            for (const saved &s : journal) {
+                if (s.node->expired) continue;
+                s.node->left = s.node->right = nullptr;
+                s.node->dist = 0;
+                queue.push_back(s.node);
+            }
+            size_t head = 0;
+            while (queue.size() - head > 1) {
+                queue.push_back(mergeNodes(queue[head], queue[head + 1]));
+                head += 2;
+            }
+            root = queue.size() > head ? queue[head] : nullptr;
+        } catch (...) {
+            for (const saved &s : journal) {
+                s.node->left = s.left;
+                s.node->right = s.right;
+                s.node->dist = s.dist;
+            }
+            root = oldRoot;
+            throw runtime_error();
+        }
+        for (const saved &s : journal) {
+            if (s.node->expired) delete s.node;
+        }
+        deadSize = 0;
+    }
+
+    static Node *copyTree(const Node *node) {
+        return tree::copy(node, [](const Node *x) {
+            Node *copy = new Node(x->data, x->expiry);
+            copy->expired = x->expired;
+            return copy;
+        });
+    }
+
+public:
+    /**
+     * @param slotWidth time span covered by one wheel bucket
+     * @param slots number of wheel buckets, rounded up to a power of two
+     */
+    explicit expiring_queue(time_type slotWidth = 1, size_t slots = 256)
+        : root(nullptr), liveSize(0), deadSize(0), cmp(), wheel(nullptr),
+          wheelSize(1), granularity(slotWidth ? slotWidth : 1), current(0) {
+        while (wheelSize < slots) wheelSize *= 2;
+        wheel = new Node *[wheelSize]();
+    }
+
+    expiring_queue(const expiring_queue &other)
+        : root(nullptr), liveSize(other.liveSize), deadSize(other.deadSize), cmp(other.cmp),
+          wheel(nullptr), wheelSize(other.wheelSize), granularity(other.granularity),
+          current(other.current) {
+        wheel = new Node *[wheelSize]();
+        try {
+            root = copyTree(other.root);
+            tree::visit(root, [this](Node *x) {
+                if (!x->expired) linkBucket(x);
+            });
+        } catch (...) {
+            tree::destroy(root);
+            delete[] wheel;
+            throw;
+        }
+    }
+
+    ~expiring_queue() {
+        tree::destroy(root);
+        delete[] wheel;
+    }
+
+    expiring_queue &operator=(const expiring_queue &other) {
+        if (this == &other) return *this;
+
+        expiring_queue tmp(other);
+        std::swap(root, tmp.root);
+        std::swap(liveSize, tmp.liveSize);
+        std::swap(deadSize, tmp.deadSize);
+        std::swap(cmp, tmp.cmp);
+        std::swap(wheel, tmp.wheel);
+        std::swap(wheelSize, tmp.wheelSize);
+        std::swap(granularity, tmp.granularity);
+        std::swap(current, tmp.current);
+        return *this;
+    }
+
+    /**
+     * @brief the largest element that has not expired. Drops any tombstone
+     * an earlier comparator failure left at the root first.
+     * @throws container_is_empty if empty() returns true
+     * @throws runtime_error if Compare throws while dropping a tombstone;
+     * the queue is unchanged apart from tombstones already dropped.
+     */
+    const T &top() {
+        if (empty()) {
+            throw container_is_empty();
+        }
+        try {
+            purgeRoot();
+        } catch (...) {
+            throw runtime_error();
+        }
+        return root->data;
+    }
+
+    /**
+     * @brief as top(), but a const queue cannot drop tombstones.
+     * @throws container_is_empty if empty() returns true
+     * @throws runtime_error if an earlier comparator failure left a
+     * tombstone at the root; the next top(), pop() or advance_time() on a
+     * non-const queue clears it.
+     */
+    const T &top() const {
+        if (empty()) {
+            throw container_is_empty();
+        }
+        if (root->expired) {
+            throw runtime_error();
+        }
+        return root->data;
+    }
+
+    /**
+     * @brief push e, expiring at time expiry.
+     * @return false (and nothing is stored) if expiry is not after now().
+     * @throws runtime_error if Compare throws; the queue is unchanged.
+     */
+    bool push(const T &e, time_type expiry) {
+        if (expiry <= current) return false;
+
+        Node *newNode = new Node(e, expiry);
+        try {
+            root = mergeNodes(root, newNode);
+        } catch (...) {
+            delete newNode;
+            throw runtime_error();
+        }
+        linkBucket(newNode);
+        ++liveSize;
+        return true;
+    }
+
+    /**
+     * @brief push e, expiring ttl time units from now().
+     */
+    bool push_for(const T &e, time_type ttl) {
+        return push(e, current + ttl);
+    }
+
+    /**
+     * @brief delete the largest element that has not expired.
+     * @throws container_is_empty if empty() returns true
+     * @throws runtime_error if Compare throws; the queue is unchanged.
+     */
+    void pop() {
+        if (empty()) {
+            throw container_is_empty();
+        }
+
+        Node *newRoot = nullptr;
+        try {
+            purgeRoot();
+            newRoot = mergeNodes(root->left, root->right);
+        } catch (...) {
+            throw runtime_error();
+        }
+        unlinkBucket(root);
+        delete root;
+        root = newRoot;
+        --liveSize;
+        try {
+            purgeRoot();
+        } catch (...) {
+            // The pop itself succeeded; the tombstone left at the root is
+            // reported by top() and dropped by the next pop().
+        }
+    }
+
+    /**
+     * @brief move the clock to now, expiring every element whose expiry is
+     * at or before it. Time never moves backwards.
+     * @return the number of elements that expired
+     * @throws runtime_error if Compare throws while dropping tombstones; the
+     * expiry itself has been applied.
+     */
+    size_t advance_time(time_type now) {
+        if (now <= current) return 0;
+
+        size_t count = 0;
+        time_type from = current / granularity, to = now / granularity;
+        if (to - from >= wheelSize) {
+            for (size_t slot = 0; slot < wheelSize; ++slot) count += expireBucket(slot, now);
+        } else {
+            for (time_type tick = from; tick <= to; ++tick) {
+                count += expireBucket(tick & (wheelSize - 1), now);
+            }
+        }
+        current = now;
+        liveSize -= count;
+        deadSize += count;
+
+        try {
+            if (deadSize > liveSize + 64) compact();
+            else purgeRoot();
+        } catch (...) {
+            throw runtime_error();
+        }
+        return count;
+    }
+
+    time_type now() const {
+        return current;
+    }
+
+    /**
+     * @brief number of elements that have not expired.
+     */
+    size_t size() const {
+        return liveSize;
+    }
+
+    bool empty() const {
+        return liveSize == 0;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,302 @@
+#ifndef SJTU_FAIR_SCHEDULER_HPP
+#define SJTU_FAIR_SCHEDULER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "exceptions.hpp"
+#include "priority_map.hpp"
+#include "priority_queue.hpp"
+
+namespace sjtu {
+
+/**
+ * A weighted fair-queuing scheduler over tenants that each own a
+ * priority_queue of jobs. Within a tenant, jobs leave in Compare order; across
+ * tenants, the next job comes from the tenant whose head job has the smallest
+ * virtual finish time (self-clocked fair queueing):
+ *
+ *   finish = start + cost / weight
+ *
+ * where start is the previous finish of a busy tenant, or
+ * max(virtual time, its last finish) for a tenant that was idle, so an idle
+ * tenant does not build up credit. The virtual time is the finish time of the
+ * last dispatched job. Over any busy period each tenant therefore receives
+ * service in proportion to its weight, within one job.
+ *
+ * The tenants sit in a priority_map keyed by finish time, so dispatch is
+ * O(log T + log n) for T tenants. Moving a tenant's whole queue to another
+ * scheduler melds the two priority_queues in O(log n).
+ */
+template<typename Tenant, typename Job, class Compare = std::less<Job>,
+         class Hash = std::hash<Tenant>, class KeyEqual = std::equal_to<Tenant>>
+class fair_scheduler {
+private:
+    struct job_entry {
+        Job job;
+        double cost;
+    };
+
+    struct jobCompare {
+        Compare cmp;
+        bool operator()(const job_entry &a, const job_entry &b) const {
+            return cmp(a.job, b.job);
+        }
+    };
+
+    struct tenant_state {
+        Tenant name;
+        priority_queue<job_entry, jobCompare> jobs;
+        double weight;
+        double start;       // virtual start time of the head job
+        double lastFinish;  // finish time of the last dispatched job
+        size_t index;       // position in registry
+    };
+
+    // A tenant's key in the top-level heap. Busy tenants come before idle
+    // ones, then the smallest finish time, then the one queued first.
+    struct tag {
+        bool busy;
+        double finish;
+        unsigned long long seq;
+        tenant_state *state;
+    };
+
+    struct tagOrder {
+        bool operator()(const tag &a, const tag &b) const {
+            if (a.busy != b.busy) return b.busy;
+            if (a.finish != b.finish) return a.finish > b.finish;
+            return a.seq > b.seq;
+        }
+    };
+
+    priority_map<Tenant, tag, tagOrder, Hash, KeyEqual> tenants;
+    std::vector<tenant_state *> registry;
+    double vtime;
+    unsigned long long nextSeq;
+    size_t jobCount;
+
+    tenant_state *find(const Tenant &t) const {
+        return tenants.contains(t) ? tenants.priority(t).state : nullptr;
+    }
+
+    tenant_state *addState(const Tenant &t, double weight) {
+        tenant_state *st = new tenant_state{t, priority_queue<job_entry, jobCompare>(), weight, 0, 0, registry.size()};
+        try {
+            registry.push_back(st);
+            tenants.upsert(t, tag{false, 0, nextSeq++, st});
+        } catch (...) {
+            if (registry.size() > st->index) registry.pop_back();
+            delete st;
+            throw;
+        }
+        return st;
+    }
+
+    void removeState(tenant_state *st) {
+        tenants.erase(st->name);
+        registry[st->index] = registry.back();
+        registry[st->index]->index = st->index;
+        registry.pop_back();
+        jobCount -= st->jobs.size();
+        delete st;
+    }
+
+    // Re-key st after its queue or weight changed. wasIdle: the queue was
+    // empty before, so the head job starts a new busy period.
+    void retag(tenant_state *st, bool wasIdle) {
+        if (st->jobs.empty()) {
+            tenants.upsert(st->name, tag{false, st->lastFinish, nextSeq++, st});
+            return;
+        }
+        if (wasIdle) st->start = vtime > st->lastFinish ? vtime : st->lastFinish;
+        tenants.upsert(st->name, tag{true, st->start + st->jobs.top().cost / st->weight, nextSeq++, st});
+    }
+
+    static void checkWeight(double weight) {
+        if (!(weight > 0)) {
+            throw runtime_error();
+        }
+    }
+
+public:
+    fair_scheduler() : tenants(), registry(), vtime(0), nextSeq(0), jobCount(0) {}
+
+    fair_scheduler(const fair_scheduler &) = delete;
+    fair_scheduler &operator=(const fair_scheduler &) = delete;
+
+    ~fair_scheduler() {
+        for (tenant_state *st : registry) delete st;
+    }
+
+    /**
+     * @brief register tenant t with the given weight, or change the weight of
+     * an existing tenant (its queued head job is re-timed).
+     * @return true if t was not registered before.
+     * @throws runtime_error if weight is not positive
+     */
+    bool add_tenant(const Tenant &t, double weight = 1) {
+        checkWeight(weight);
+        tenant_state *st = find(t);
+        if (!st) {
+            addState(t, weight);
+            return true;
+        }
+        st->weight = weight;
+        retag(st, false);
+        return false;
+    }
+
+    /**
+     * @brief unregister tenant t and drop its queued jobs.
+     * @return true if t was registered.
+     */
+    bool remove_tenant(const Tenant &t) {
+        tenant_state *st = find(t);
+        if (!st) return false;
+        removeState(st);
+        return true;
+    }
+
+    bool contains(const Tenant &t) const {
+        return find(t) != nullptr;
+    }
+
+    /**
+     * @throws index_out_of_bound if t is not registered
+     */
+    double weight(const Tenant &t) const {
+        return tenants.priority(t).state->weight;
+    }
+
+    /**
+     * @brief number of jobs queued by tenant t.
+     * @throws index_out_of_bound if t is not registered
+     */
+    size_t backlog(const Tenant &t) const {
+        return tenants.priority(t).state->jobs.size();
+    }
+
+    /**
+     * @brief queue job for tenant t; an unknown tenant is registered with
+     * weight 1. cost is the job's length in the same units for every tenant.
+     * @throws runtime_error if Compare throws; the queue of t is unchanged.
+     */
+    void push(const Tenant &t, const Job &job, double cost = 1) {
+        tenant_state *st = find(t);
+        if (!st) st = addState(t, 1);
+        bool wasIdle = st->jobs.empty();
+        st->jobs.push(job_entry{job, cost});
+        ++jobCount;
+        retag(st, wasIdle);
+    }
+
+    /**
+     * @brief the job that pop() dispatches next.
+     * @throws container_is_empty if empty() returns true
+     */
+    const Job &top() const {
+        if (empty()) {
+            throw container_is_empty();
+        }
+        return tenants.top_priority().state->jobs.top().job;
+    }
+
+    /**
+     * @brief the tenant owning top().
+     * @throws container_is_empty if empty() returns true
+     */
+    const Tenant &top_tenant() const {
+        if (empty()) {
+            throw container_is_empty();
+        }
+        return tenants.top_key();
+    }
+
+    /**
+     * @brief dispatch top() and advance the virtual time to its finish time.
+     * @throws container_is_empty if empty() returns true
+     * @throws runtime_error if Compare throws; the scheduler is unchanged.
+     */
+    void pop() {
+        if (empty()) {
+            throw container_is_empty();
+        }
+        tag head = tenants.top_priority();
+        tenant_state *st = head.state;
+        st->jobs.pop();
+        --jobCount;
+        vtime = head.finish;
+        st->lastFinish = head.finish;
+        st->start = head.finish;
+        retag(st, false);
+    }
+
+    /**
+     * @brief move the whole queue of tenant t to dest, where it is melded
+     * with t's queue if dest already has t (keeping dest's weight), and
+     * unregister t here. O(log n) for the meld plus O(log T) per scheduler.
+     * @throws index_out_of_bound if t is not registered
+     * @throws runtime_error if Compare throws; both schedulers are unchanged.
+     */
+    void migrate(const Tenant &t, fair_scheduler &dest) {
+        if (this == &dest) return;
+
+        tenant_state *st = tenants.priority(t).state;
+        tenant_state *target = dest.find(t);
+        bool added = !target;
+        if (added) target = dest.addState(t, st->weight);
+        bool wasIdle = target->jobs.empty();
+        size_t moved = st->jobs.size();
+        try {
+            target->jobs.merge(st->jobs);
+        } catch (...) {
+            if (added) dest.removeState(target);
+            throw;
+        }
+        dest.jobCount += moved;
+        jobCount -= moved;
+        dest.retag(target, wasIdle);
+        removeState(st);
+    }
+
+    /**
+     * @brief migrate every tenant of other into this scheduler; other is
+     * left without tenants. O(T log n) for T tenants in other.
+     * @throws runtime_error if Compare throws; tenants moved so far stay
+     * moved, the failing one stays in other.
+     */
+    void merge(fair_scheduler &other) {
+        if (this == &other) return;
+
+        while (!other.registry.empty()) {
+            other.migrate(other.registry.back()->name, *this);
+        }
+    }
+
+    /**
+     * @brief finish time of the last dispatched job.
+     */
+    double virtual_time() const {
+        return vtime;
+    }
+
+    size_t tenant_count() const {
+        return registry.size();
+    }
+
+    /**
+     * @brief total number of queued jobs over all tenants.
+     */
+    size_t size() const {
+        return jobCount;
+    }
+
+    bool empty() const {
+        return jobCount == 0;
+    }
+};
+
+}
+
+#endif
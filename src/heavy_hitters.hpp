@@ -0,0 +1,195 @@
+#ifndef SJTU_HEAVY_HITTERS_HPP
+#define SJTU_HEAVY_HITTERS_HPP
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "exceptions.hpp"
+#include "priority_map.hpp"
+
+namespace sjtu {
+
+/**
+ * Tracks the most frequent keys of a stream in at most k counters
+ * (space-saving). A key that is already tracked has its counter increased;
+ * a new key gets a free counter, or else takes over the smallest one and
+ * inherits its count as error:
+ *
+ *   count(new key) = min + weight,  error(new key) = min
+ *
+ * so for every tracked key
+ *
+ *   count - error <= true frequency <= count,  error <= total() / k
+ *
+ * and every key with a true frequency above total() / k is tracked.
+ *
+ * The counters sit in a priority_map ordered as a min-heap by count, which
+ * gives the smallest counter and the tracked lookup in one structure; an
+ * update is one hash lookup, O(1) expected, and an increase-key through the
+ * handle it returns, O(log k). Memory stays O(k) however long the stream is.
+ */
+template<typename Key, typename Count = unsigned long long,
+         class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+class heavy_hitters {
+public:
+    struct item {
+        Key key;
+        Count count;
+        Count error;
+    };
+
+private:
+    struct counter {
+        Count count;
+        Count error;
+    };
+
+    // Smallest count on top.
+    struct counterCompare {
+        bool operator()(const counter &a, const counter &b) const {
+            return b.count < a.count;
+        }
+    };
+
+    using map_type = priority_map<Key, counter, counterCompare, Hash, KeyEqual>;
+    using handle = typename map_type::handle;
+
+    map_type counters;
+    size_t k;
+    Count streamTotal;
+
+    // Count a key that is not tracked must have stayed below.
+    Count floor() const {
+        return counters.size() < k ? Count() : counters.top_priority().count;
+    }
+
+    // Keep the k largest counters of those pushed.
+    void keep(map_type &m, const Key &key, const counter &c) const {
+        if (m.size() == k) {
+            if (!(m.top_priority().count < c.count)) return;
+            m.pop();
+        }
+        m.upsert(key, c);
+    }
+
+public:
+    /**
+     * @brief a tracker with k counters.
+     * @throws runtime_error if k is 0
+     */
+    explicit heavy_hitters(size_t k) : counters(), k(k), streamTotal() {
+        if (k == 0) {
+            throw runtime_error();
+        }
+    }
+
+    /**
+     * @brief count weight more occurrences of key.
+     */
+    void update(const Key &key, Count weight = 1) {
+        streamTotal += weight;
+        if (handle h = counters.find(key)) {
+            counter c = counters.priority(h);
+            c.count += weight;
+            counters.update(h, c);
+        } else if (counters.size() < k) {
+            counters.upsert(key, counter{weight, Count()});
+        } else {
+            Count min = counters.top_priority().count;
+            counters.pop();
+            counters.upsert(key, counter{min + weight, min});
+        }
+    }
+
+    /**
+     * @brief an upper bound on the frequency of key: its count if tracked,
+     * otherwise the smallest count once all k counters are in use.
+     */
+    Count estimate(const Key &key) const {
+        handle h = counters.find(key);
+        return h ? counters.priority(h).count : floor();
+    }
+
+    /**
+     * @brief how much estimate(key) may exceed the true frequency.
+     */
+    Count error(const Key &key) const {
+        handle h = counters.find(key);
+        return h ? counters.priority(h).error : floor();
+    }
+
+    bool contains(const Key &key) const {
+        return counters.contains(key);
+    }
+
+    /**
+     * @brief the n largest counters, by decreasing count.
+     */
+    std::vector<item> top(size_t n) const {
+        map_type copy(counters);
+        while (copy.size() > n) copy.pop();
+        std::vector<item> result(copy.size());
+        for (size_t i = result.size(); i-- > 0; copy.pop()) {
+            result[i] = item{copy.top_key(), copy.top_priority().count, copy.top_priority().error};
+        }
+        return result;
+    }
+
+    /**
+     * @brief combine the counters of other, e.g. from another shard of the
+     * stream, into this tracker; other is cleared. A key missing from one
+     * side is charged that side's smallest count as both count and error,
+     * so count - error <= true frequency <= count and estimate() still hold
+     * for the concatenated stream; error may grow to the sum of the two
+     * sides' total() / k. Costs O(k log k).
+     */
+    void merge(heavy_hitters &other) {
+        if (this == &other) return;
+
+        const Count mine = floor(), theirs = other.floor();
+        map_type combined;
+        counters.for_each([&](const Key &key, const counter &c) {
+            counter sum = c;
+            if (handle h = other.counters.find(key)) {
+                const counter &o = other.counters.priority(h);
+                sum.count += o.count;
+                sum.error += o.error;
+            } else {
+                sum.count += theirs;
+                sum.error += theirs;
+            }
+            keep(combined, key, sum);
+        });
+        other.counters.for_each([&](const Key &key, const counter &c) {
+            if (counters.contains(key)) return;
+            keep(combined, key, counter{c.count + mine, c.error + mine});
+        });
+        counters.swap(combined);
+        streamTotal += other.streamTotal;
+        map_type().swap(other.counters);
+        other.streamTotal = Count();
+    }
+
+    /**
+     * @brief total weight of all updates seen.
+     */
+    Count total() const {
+        return streamTotal;
+    }
+
+    size_t capacity() const {
+        return k;
+    }
+
+    size_t size() const {
+        return counters.size();
+    }
+
+    bool empty() const {
+        return counters.empty();
+    }
+};
+
+}
+
+#endif
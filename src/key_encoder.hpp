@@ -0,0 +1,194 @@
+#ifndef SJTU_KEY_ENCODER_HPP
+#define SJTU_KEY_ENCODER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+enum class key_order { ascending, descending };
+
+/**
+ * One field of a composite key: a value of type T stored in Bits bits, so
+ * that comparing the encoded bits as unsigned integers orders the values
+ * like operator< (ascending) or like operator> (descending).
+ *
+ *  - unsigned integers and bool are stored as they are;
+ *  - signed integers are biased by 2^(Bits-1);
+ *  - float and double use all their bits: the sign bit is flipped for
+ *    positive values and every bit for negative ones, so -0.0 sorts just
+ *    below +0.0 and NaNs sort outside the infinities;
+ *  - enums are stored as their underlying type.
+ *
+ * Integers that do not fit in Bits make encode() throw index_out_of_bound.
+ */
+template<typename T, unsigned Bits = (std::is_same<T, bool>::value ? 1 : sizeof(T) * 8),
+         key_order Order = key_order::ascending>
+struct key_field {
+    using value_type = T;
+    static constexpr unsigned bits = Bits;
+    static constexpr uint64_t mask = Bits == 64 ? ~0ull : (1ull << Bits) - 1;
+
+    static_assert(Bits > 0 && Bits <= 64, "a key field holds 1 to 64 bits");
+    static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+                  "key fields are arithmetic or enum types");
+    static_assert(!std::is_floating_point<T>::value || Bits == sizeof(T) * 8,
+                  "floating-point fields keep all their bits");
+
+private:
+    template<typename U, bool = std::is_enum<U>::value>
+    struct underlying {
+        using type = U;
+    };
+
+    template<typename U>
+    struct underlying<U, true> {
+        using type = typename std::underlying_type<U>::type;
+    };
+
+    using raw_type = typename underlying<T>::type;
+    using float_bits = typename std::conditional<sizeof(raw_type) == 4, uint32_t, uint64_t>::type;
+
+    static uint64_t toBits(raw_type v) {
+        if constexpr (std::is_floating_point<raw_type>::value) {
+            const uint64_t sign = 1ull << (Bits - 1);
+            float_bits f;
+            std::memcpy(&f, &v, sizeof(v));
+            uint64_t b = f;
+            return (b & sign) ? ~b & mask : b | sign;
+        } else if constexpr (std::is_signed<raw_type>::value) {
+            const int64_t x = (int64_t)v;
+            if (Bits < 64 && (x < -(int64_t)(1ull << (Bits - 1)) || x >= (int64_t)(1ull << (Bits - 1)))) {
+                throw index_out_of_bound();
+            }
+            return ((uint64_t)x + (1ull << (Bits - 1))) & mask;
+        } else {
+            const uint64_t x = (uint64_t)v;
+            if (x & ~mask) {
+                throw index_out_of_bound();
+            }
+            return x;
+        }
+    }
+
+    static raw_type fromBits(uint64_t b) {
+        if constexpr (std::is_floating_point<raw_type>::value) {
+            const uint64_t sign = 1ull << (Bits - 1);
+            float_bits f = (float_bits)((b & sign) ? b ^ sign : ~b & mask);
+            raw_type v;
+            std::memcpy(&v, &f, sizeof(v));
+            return v;
+        } else if constexpr (std::is_signed<raw_type>::value) {
+            return (raw_type)(int64_t)(b - (1ull << (Bits - 1)));
+        } else {
+            return (raw_type)b;
+        }
+    }
+
+public:
+    /**
+     * @throws index_out_of_bound if an integer value does not fit in Bits
+     */
+    static uint64_t encode(const T &value) {
+        uint64_t b = toBits((raw_type)value);
+        return Order == key_order::ascending ? b : mask - b;
+    }
+
+    static T decode(uint64_t b) {
+        b &= mask;
+        return (T)fromBits(Order == key_order::ascending ? b : mask - b);
+    }
+};
+
+/**
+ * Packs a tuple of key_fields into one unsigned integer, first field in the
+ * most significant bits, so that the integers compare like the tuples do
+ * lexicographically. The key is uint32_t, uint64_t or unsigned __int128,
+ * the smallest that holds every field.
+ *
+ * Encoding once when an element is created lets a queue compare keys with
+ * one integer compare instead of a branch per field. Keys of at most 64
+ * bits can also go to the engines that need integer keys:
+ * compressed_priority_queue, veb_priority_queue (up to 32 bits) and the
+ * comparison-free radix sort in priority_queue::freeze() under std::less or
+ * std::greater. Wider keys get only the cheaper compare. For example,
+ * earliest deadline first, then the higher class, then FIFO in a
+ * max-queue:
+ *
+ *   using edf = key_encoder<key_field<uint32_t, 32, key_order::descending>,
+ *                           key_field<uint8_t, 4>,
+ *                           key_field<uint32_t, 28, key_order::descending>>;
+ *   priority_queue_kv<edf::key_type, Job> q;
+ *   q.emplace(edf::encode(deadline, cls, seq), job);
+ */
+template<class... Fields>
+class key_encoder {
+public:
+    static constexpr unsigned bits = (Fields::bits + ...);
+
+#ifdef __SIZEOF_INT128__
+    static_assert(bits <= 128, "a composite key holds at most 128 bits");
+    using key_type = typename std::conditional<bits <= 32, uint32_t,
+                     typename std::conditional<bits <= 64, uint64_t, unsigned __int128>::type>::type;
+#else
+    static_assert(bits <= 64, "a composite key holds at most 64 bits here");
+    using key_type = typename std::conditional<bits <= 32, uint32_t, uint64_t>::type;
+#endif
+
+    using tuple_type = std::tuple<typename Fields::value_type...>;
+
+    template<size_t I>
+    using field = typename std::tuple_element<I, std::tuple<Fields...>>::type;
+
+private:
+    static constexpr unsigned fieldBits[sizeof...(Fields)] = {Fields::bits...};
+
+    // Bits below field I.
+    template<size_t I>
+    static constexpr unsigned shift() {
+        unsigned s = 0;
+        for (size_t j = I + 1; j < sizeof...(Fields); ++j) s += fieldBits[j];
+        return s;
+    }
+
+    // Shift key up by b bits and put v below. A field as wide as the key
+    // can only be the first one, so key is still 0 then.
+    static key_type append(key_type key, unsigned b, uint64_t v) {
+        return b >= sizeof(key_type) * 8 ? (key_type)v : (key_type)((key << b) | (key_type)v);
+    }
+
+    template<size_t... I>
+    static tuple_type decodeAll(key_type key, std::index_sequence<I...>) {
+        return tuple_type(get<I>(key)...);
+    }
+
+public:
+    /**
+     * @throws index_out_of_bound if an integer value does not fit its field
+     */
+    static key_type encode(const typename Fields::value_type &...values) {
+        key_type key = 0;
+        ((key = append(key, Fields::bits, Fields::encode(values))), ...);
+        return key;
+    }
+
+    /**
+     * @brief the value of field I stored in key.
+     */
+    template<size_t I>
+    static typename field<I>::value_type get(key_type key) {
+        return field<I>::decode((uint64_t)(key >> shift<I>()));
+    }
+
+    static tuple_type decode(key_type key) {
+        return decodeAll(key, std::index_sequence_for<Fields...>());
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef SJTU_LEFTIST_TREE_HPP
+#define SJTU_LEFTIST_TREE_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace sjtu {
+
+/**
+ * Leftist-heap routines shared by the node-based queues that sit next to
+ * priority_queue (priority_queue_kv, expiring_queue). priority_queue.hpp
+ * keeps its own copy because it has to compile on its own.
+ *
+ * Node needs `Node *left, *right` and `int dist` (null path length, -1 for
+ * an empty tree). The heaps order nodes with a functor before(a, b) that is
+ * true when a ranks below b, i.e. b belongs nearer the root.
+ */
+template<class Node>
+struct leftist_tree {
+    static int dist(const Node *x) {
+        return x ? x->dist : -1;
+    }
+
+    // Every comparison happens on the way down and links are only rewritten
+    // on the way back up, so a throwing before() leaves both heaps
+    // untouched. Recursion follows the right spines: O(log n) deep.
+    template<class Before>
+    static Node *merge(Node *h1, Node *h2, Before before) {
+        if (!h1) return h2;
+        if (!h2) return h1;
+
+        if (before(h1, h2)) {
+            std::swap(h1, h2);
+        }
+
+        h1->right = merge(h1->right, h2, before);
+
+        if (dist(h1->left) < dist(h1->right)) {
+            std::swap(h1->left, h1->right);
+        }
+        h1->dist = dist(h1->right) + 1;
+
+        return h1;
+    }
+
+    // Copy a tree; clone(x) returns a childless copy of node x. Walks left
+    // spines and stacks the right children, since sorted input leaves one
+    // long left chain. If clone throws, the partial copy is freed.
+    template<class Clone>
+    static Node *copy(const Node *x, Clone clone) {
+        if (!x) return nullptr;
+
+        Node *copyRoot = clone(x);
+        copyRoot->left = copyRoot->right = nullptr;
+        copyRoot->dist = x->dist;
+        try {
+            std::vector<std::pair<const Node *, Node *>> pending;
+            pending.push_back(std::make_pair(x, copyRoot));
+            while (!pending.empty()) {
+                std::pair<const Node *, Node *> next = pending.back();
+                pending.pop_back();
+                for (const Node *from = next.first; from; from = from->left) {
+                    Node *to = next.second;
+                    if (from->right) {
+                        to->right = clone(from->right);
+                        to->right->left = to->right->right = nullptr;
+                        to->right->dist = from->right->dist;
+                        pending.push_back(std::make_pair(from->right, to->right));
+                    }
+                    if (from->left) {
+                        to->left = clone(from->left);
+                        to->left->left = to->left->right = nullptr;
+                        to->left->dist = from->left->dist;
+                        next.second = to->left;
+                    }
+                }
+            }
+        } catch (...) {
+            destroy(copyRoot);
+            throw;
+        }
+        return copyRoot;
+    }
+
+    // Rotates left children onto the right spine instead of recursing, so
+    // long left chains cannot exhaust the stack.
+    static void destroy(Node *x) {
+        while (x) {
+            if (x->left) {
+                Node *l = x->left;
+                x->left = l->right;
+                l->right = x;
+                x = l;
+            } else {
+                Node *r = x->right;
+                delete x;
+                x = r;
+            }
+        }
+    }
+
+    // Call f on every node, parents before children, without recursing.
+    template<class F>
+    static void visit(Node *x, F f) {
+        std::vector<Node *> stack;
+        if (x) stack.push_back(x);
+        while (!stack.empty()) {
+            Node *y = stack.back();
+            stack.pop_back();
+            if (y->left) stack.push_back(y->left);
+            if (y->right) stack.push_back(y->right);
+            f(y);
+        }
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,232 @@
+#ifndef SJTU_MEDIAN_TRACKER_HPP
+#define SJTU_MEDIAN_TRACKER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "exceptions.hpp"
+#include "addressable_heap.hpp"
+
+namespace sjtu {
+
+/**
+ * Tracks the q-quantile of a multiset with a pair of addressable heaps: a
+ * max-heap holding the lowest ceil(q * n) elements and a min-heap holding the
+ * rest, rebalanced after every change. The quantile is the top of the lower
+ * heap, i.e. the element of rank ceil(q * n) (1-based, ascending by Compare).
+ *
+ * insert() returns a handle that can later be passed to erase(); handles stay
+ * valid while elements migrate between the two heaps.
+ */
+template<typename T, class Compare = std::less<T>>
+class quantile_tracker {
+private:
+    struct item {
+        T value;
+        mutable bool low;  // which heap holds it; not part of the ordering
+    };
+
+    // Both halves share one node type so nodes can move between them; the
+    // upper half simply compares in reverse.
+    struct sideCompare {
+        Compare cmp;
+        bool reversed;
+        bool operator()(const item &a, const item &b) const {
+            return reversed ? cmp(b.value, a.value) : cmp(a.value, b.value);
+        }
+    };
+
+    using heap_type = addressable_heap<item, sideCompare>;
+
+public:
+    using handle = typename heap_type::handle;
+
+private:
+    heap_type lower;
+    heap_type upper;
+    double q;
+    Compare cmp;
+
+    // Every change runs under undo: on failure it is rolled back and the
+    // nodes in flipped get their side back, so no node is ever freed or
+    // left on the wrong side. Kept between calls to reuse their memory.
+    typename heap_type::journal undo;
+    std::vector<handle> flipped;
+
+    size_t target(size_t n) const {
+        if (n == 0) return 0;
+        double want = q * n;
+        size_t t = static_cast<size_t>(want);
+        if (t < want) ++t;
+        if (t < 1) t = 1;
+        return t > n ? n : t;
+    }
+
+    // Move the top of from to the other half. A failure needs no local
+    // repair since the whole operation is rolled back.
+    void shiftTop(heap_type &from, heap_type &to) {
+        handle h = from.extract(from.top_handle());
+        flipped.push_back(h);
+        h->value().low = !h->value().low;
+        to.insert(h);
+    }
+
+    void track(quantile_tracker &other, typename heap_type::journal *log) {
+        lower.track(log);
+        upper.track(log);
+        other.lower.track(log);
+        other.upper.track(log);
+    }
+
+    void begin(quantile_tracker &other) {
+        undo.clear();
+        flipped.clear();
+        track(other, &undo);
+    }
+
+    void commit(quantile_tracker &other) {
+        track(other, nullptr);
+        undo.clear();
+        flipped.clear();
+    }
+
+    void rollback(quantile_tracker &other) {
+        track(other, nullptr);
+        undo.rollback();
+        for (size_t i = 0; i < flipped.size(); ++i) flipped[i]->value().low = !flipped[i]->value().low;
+        flipped.clear();
+    }
+
+    void rebalance() {
+        size_t want = target(size());
+        while (lower.size() > want) shiftTop(lower, upper);
+        while (lower.size() < want) shiftTop(upper, lower);
+    }
+
+public:
+    /**
+     * @param quantile in (0, 1]; 0.5 tracks the (lower) median
+     */
+    explicit quantile_tracker(double quantile, const Compare &c = Compare())
+        : lower(sideCompare{c, false}), upper(sideCompare{c, true}), q(quantile), cmp(c) {}
+
+    quantile_tracker(const quantile_tracker &) = delete;
+    quantile_tracker &operator=(const quantile_tracker &) = delete;
+
+    /**
+     * @brief add e in O(log n).
+     * @return a handle for erase()
+     * @throws runtime_error if Compare throws; the tracker is unchanged.
+     */
+    handle insert(const T &e) {
+        handle h = heap_type::make_handle(item{e, true});
+        begin(*this);
+        try {
+            if (lower.empty() || !cmp(lower.top().value, e)) {
+                lower.insert(h);
+            } else {
+                h->value().low = false;
+                upper.insert(h);
+            }
+            rebalance();
+        } catch (...) {
+            // Nothing links to h once the journal is replayed.
+            rollback(*this);
+            delete h;
+            throw runtime_error();
+        }
+        commit(*this);
+        return h;
+    }
+
+    /**
+     * @brief remove the element behind h in O(log n).
+     * @throws runtime_error if Compare throws; the tracker is unchanged and
+     * h is still valid.
+     */
+    void erase(handle h) {
+        begin(*this);
+        try {
+            if (h->value().low) lower.extract(h);
+            else upper.extract(h);
+            rebalance();
+        } catch (...) {
+            rollback(*this);
+            throw runtime_error();
+        }
+        commit(*this);
+        delete h;
+    }
+
+    static const T &value(handle h) {
+        return h->value().value;
+    }
+
+    /**
+     * @brief the tracked quantile in O(1).
+     * @throws container_is_empty if empty() returns true
+     */
+    const T &quantile() const {
+        return lower.top().value;
+    }
+
+    size_t size() const {
+        return lower.size() + upper.size();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief move every element of other into this tracker; other is cleared
+     * and its handles now refer to this tracker. The halves are melded in
+     * O(log n); afterwards each element of one half that lies on the wrong
+     * side of the other is swapped across, so the total cost is
+     * O((k + 1) log n) where k is the number of such misplaced pairs plus the
+     * size imbalance. This is not O(log n): k approaches the smaller size
+     * when the two inputs barely overlap.
+     * @throws runtime_error if Compare throws; both trackers are unchanged.
+     * Every link the merge rewrites is journaled until it completes, which
+     * takes O((k + 1) log n) extra memory.
+     */
+    void merge(quantile_tracker &other) {
+        if (this == &other) return;
+
+        begin(other);
+        try {
+            lower.merge(other.lower);
+            upper.merge(other.upper);
+            while (!lower.empty() && !upper.empty()
+                   && cmp(upper.top().value, lower.top().value)) {
+                shiftTop(lower, upper);
+                shiftTop(upper, lower);
+            }
+            rebalance();
+        } catch (...) {
+            rollback(other);
+            throw runtime_error();
+        }
+        commit(other);
+    }
+};
+
+/**
+ * A quantile_tracker fixed at q = 0.5; median() is the lower median.
+ */
+template<typename T, class Compare = std::less<T>>
+class median_tracker : public quantile_tracker<T, Compare> {
+public:
+    explicit median_tracker(const Compare &c = Compare()) : quantile_tracker<T, Compare>(0.5, c) {}
+
+    /**
+     * @throws container_is_empty if empty() returns true
+     */
+    const T &median() const {
+        return this->quantile();
+    }
+};
+
+}
+
+#endif
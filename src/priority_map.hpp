@@ -0,0 +1,342 @@
+#ifndef SJTU_PRIORITY_MAP_HPP
+#define SJTU_PRIORITY_MAP_HPP
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include "exceptions.hpp"
+#include "addressable_heap.hpp"
+
+namespace sjtu {
+
+/**
+ * A priority queue holding at most one entry per key. The heap part is an
+ * addressable_heap; an open-addressing (linear probing) table maps each key
+ * to its heap node, so re-prioritising a key never leaves a stale duplicate
+ * behind.
+ *
+ * top_key() is the key with the largest priority with respect to Compare.
+ */
+template<typename Key, typename Priority, class Compare = std::less<Priority>,
+         class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>>
+class priority_map {
+private:
+    struct entry {
+        Key key;
+        Priority priority;
+    };
+
+    struct entryCompare {
+        Compare cmp;
+        bool operator()(const entry &a, const entry &b) const {
+            return cmp(a.priority, b.priority);
+        }
+    };
+
+    using heap_type = addressable_heap<entry, entryCompare>;
+
+public:
+    // Refers to one entry until it is erased or popped.
+    using handle = typename heap_type::handle;
+
+private:
+    heap_type heap;
+    handle *slots;     // nullptr marks an empty slot
+    size_t capacity;   // always a power of two
+    Hash hasher;
+    KeyEqual keyEqual;
+
+    // std::hash of an integer is usually the identity, so sequential or
+    // strided keys would fill neighbouring slots in long runs. Multiply by
+    // 2^64 / phi and fold the well-mixed high half onto the low bits.
+    size_t home(const Key &key) const {
+        unsigned long long h = (unsigned long long)hasher(key) * 0x9E3779B97F4A7C15ull;
+        return (size_t)(h ^ h >> 32) & (capacity - 1);
+    }
+
+    // Index of the slot holding key, or of the empty slot ending its probe run.
+    size_t findSlot(const Key &key) const {
+        size_t i = home(key);
+        while (slots[i] && !keyEqual(slots[i]->value().key, key)) {
+            i = (i + 1) & (capacity - 1);
+        }
+        return i;
+    }
+
+    handle findHandle(const Key &key) const {
+        return slots[findSlot(key)];
+    }
+
+    // Backward-shift deletion keeps probe runs contiguous without tombstones.
+    void eraseSlot(size_t i) {
+        size_t j = i;
+        while (true) {
+            j = (j + 1) & (capacity - 1);
+            if (!slots[j]) break;
+            size_t k = home(slots[j]->value().key);
+            // Move slots[j] into the hole unless its home lies cyclically in (i, j].
+            if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j)) continue;
+            slots[i] = slots[j];
+            i = j;
+        }
+        slots[i] = nullptr;
+    }
+
+    void insertSlot(handle h) {
+        slots[findSlot(h->value().key)] = h;
+    }
+
+    // Make room for n entries at a load factor of at most 3/4.
+    void reserveSlots(size_t n) {
+        size_t newCapacity = capacity;
+        while (n * 4 >= newCapacity * 3) newCapacity *= 2;
+        if (newCapacity == capacity) return;
+
+        handle *newSlots = new handle[newCapacity]();
+        handle *oldSlots = slots;
+        size_t oldCapacity = capacity;
+        slots = newSlots;
+        capacity = newCapacity;
+        for (size_t i = 0; i < oldCapacity; ++i) {
+            if (oldSlots[i]) insertSlot(oldSlots[i]);
+        }
+        delete[] oldSlots;
+    }
+
+    void rebuildIndex() {
+        for (size_t i = 0; i < capacity; ++i) slots[i] = nullptr;
+        heap.for_each_handle([this](handle h) { insertSlot(h); });
+    }
+
+public:
+    /**
+     * @brief default constructor
+     */
+    priority_map() : heap(), slots(nullptr), capacity(16), hasher(), keyEqual() {
+        slots = new handle[capacity]();
+    }
+
+    explicit priority_map(const Compare &c) : heap(entryCompare{c}), slots(nullptr), capacity(16), hasher(), keyEqual() {
+        slots = new handle[capacity]();
+    }
+
+    /**
+     * @brief copy constructor
+     */
+    priority_map(const priority_map &other)
+        : heap(other.heap), slots(nullptr), capacity(other.capacity),
+          hasher(other.hasher), keyEqual(other.keyEqual) {
+        slots = new handle[capacity]();
+        rebuildIndex();
+    }
+
+    ~priority_map() {
+        delete[] slots;
+    }
+
+    priority_map &operator=(const priority_map &other) {
+        if (this == &other) return *this;
+
+        priority_map tmp(other);
+        swap(tmp);
+        return *this;
+    }
+
+    void swap(priority_map &other) {
+        heap.swap(other.heap);
+        std::swap(slots, other.slots);
+        std::swap(capacity, other.capacity);
+        std::swap(hasher, other.hasher);
+        std::swap(keyEqual, other.keyEqual);
+    }
+
+    /**
+     * @brief insert key with priority p, or set the priority of an existing key.
+     * @return true if the key was not present before.
+     * @throws runtime_error if Compare throws; the map is unchanged.
+     */
+    bool upsert(const Key &key, const Priority &p) {
+        reserveSlots(heap.size() + 1);
+        size_t i = findSlot(key);
+        if (slots[i]) {
+            heap.update(slots[i], entry{key, p});
+            return false;
+        }
+        slots[i] = heap.push(entry{key, p});
+        return true;
+    }
+
+    /**
+     * @brief remove key in O(log n).
+     * @return true if the key was present.
+     * @throws runtime_error if Compare throws; the map is unchanged.
+     */
+    bool erase(const Key &key) {
+        size_t i = findSlot(key);
+        if (!slots[i]) return false;
+        heap.erase(slots[i]);
+        eraseSlot(i);
+        return true;
+    }
+
+    bool contains(const Key &key) const {
+        return findHandle(key) != nullptr;
+    }
+
+    /**
+     * @brief the entry of key, or nullptr if it is not present. Reading or
+     * changing the priority through the handle needs no further lookup.
+     */
+    handle find(const Key &key) const {
+        return findHandle(key);
+    }
+
+    /**
+     * @brief priority of the entry behind h.
+     */
+    const Priority &priority(handle h) const {
+        return h->value().priority;
+    }
+
+    /**
+     * @brief set the priority of the entry behind h in O(log n).
+     * @throws runtime_error if Compare throws; the map is unchanged.
+     */
+    void update(handle h, const Priority &p) {
+        heap.update(h, entry{h->value().key, p});
+    }
+
+    /**
+     * @brief current priority of key.
+     * @throws index_out_of_bound if key is not present
+     */
+    const Priority &priority(const Key &key) const {
+        handle h = findHandle(key);
+        if (!h) {
+            throw index_out_of_bound();
+        }
+        return h->value().priority;
+    }
+
+    /**
+     * @throws container_is_empty if empty() returns true
+     */
+    const Key &top_key() const {
+        return heap.top().key;
+    }
+
+    /**
+     * @throws container_is_empty if empty() returns true
+     */
+    const Priority &top_priority() const {
+        return heap.top().priority;
+    }
+
+    /**
+     * @brief remove the entry with the largest priority.
+     * @throws container_is_empty if empty() returns true
+     * @throws runtime_error if Compare throws; the map is unchanged.
+     */
+    void pop() {
+        handle h = heap.top_handle();
+        size_t i = findSlot(h->value().key);
+        heap.pop();
+        eraseSlot(i);
+    }
+
+    size_t size() const {
+        return heap.size();
+    }
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    /**
+     * @brief call f(key, priority) for every entry, in unspecified order.
+     */
+    template<class F>
+    void for_each(F f) const {
+        heap.for_each_handle([&f](handle h) { f(h->value().key, h->value().priority); });
+    }
+
+    /**
+     * @brief move every entry of other into this map; other is cleared.
+     * For a key present in both, the resulting priority is
+     * combine(this priority, other priority).
+     * Costs O(d log n + m) for m entries in other, d of them shared keys;
+     * without shared keys this is a single O(log n) meld plus re-indexing.
+     * @throws runtime_error if Compare throws while resolving a shared key;
+     * entries already combined stay combined, and the rest of both maps,
+     * including the key being resolved, is unchanged.
+     */
+    template<class Combine>
+    void merge(priority_map &other, Combine combine) {
+        if (this == &other) return;
+
+        reserveSlots(heap.size() + other.size());
+        typename heap_type::journal undo;
+        try {
+            for (size_t j = 0; j < other.capacity; ++j) {
+                handle theirs = other.slots[j];
+                if (!theirs) continue;
+                size_t i = findSlot(theirs->value().key);
+                handle mine = slots[i];
+                if (!mine) continue;
+                entry combined{mine->value().key, combine(mine->value().priority, theirs->value().priority)};
+                // Unlink theirs under a journal, so it can go back if the
+                // update of mine fails, and free it only once that succeeded.
+                other.heap.track(&undo);
+                try {
+                    other.heap.extract(theirs);
+                } catch (...) {
+                    other.heap.track(nullptr);
+                    throw;
+                }
+                other.heap.track(nullptr);
+                try {
+                    heap.update(mine, combined);
+                } catch (...) {
+                    undo.rollback();
+                    throw;
+                }
+                undo.clear();
+                delete theirs;
+                other.slots[j] = nullptr;
+            }
+        } catch (...) {
+            other.rebuildIndex();
+            throw;
+        }
+        try {
+            heap.merge(other.heap);
+        } catch (...) {
+            other.rebuildIndex();
+            throw;
+        }
+        for (size_t j = 0; j < other.capacity; ++j) {
+            if (other.slots[j]) {
+                insertSlot(other.slots[j]);
+                other.slots[j] = nullptr;
+            }
+        }
+    }
+
+    /**
+     * @brief merge keeping, for a shared key, the larger of the two priorities.
+     */
+    void merge(priority_map &other) {
+        Compare cmp = heap.value_comp().cmp;
+        merge(other, [&cmp](const Priority &a, const Priority &b) {
+            try {
+                return cmp(a, b) ? b : a;
+            } catch (...) {
+                throw runtime_error();
+            }
+        });
+    }
+};
+
+}
+
+#endif
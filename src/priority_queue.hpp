@@ -7,6 +7,67 @@
 
 namespace sjtu {
 
+// The few type traits priority_queue needs, spelled out here because this
+// header may only include the starter headers.
+namespace priority_queue_traits {
+
+template<class A, class B>
+struct same {
+    static const bool value = false;
+};
+
+template<class A>
+struct same<A, A> {
+    static const bool value = true;
+};
+
+// policy_tag<P>::type exists only for execution policies (execution.hpp),
+// whatever references or const P carries.
+template<class P>
+struct policy_tag {
+    typedef typename P::execution_policy_tag type;
+};
+
+template<class P>
+struct policy_tag<P &> : policy_tag<P> {};
+
+template<class P>
+struct policy_tag<const P> : policy_tag<P> {};
+
+// The integer types freeze() can radix sort, with the unsigned type of the
+// same width.
+template<class K>
+struct integer {
+    static const bool value = false;
+};
+
+#define SJTU_PRIORITY_QUEUE_INTEGER(K, U) \
+    template<> \
+    struct integer<K> { \
+        static const bool value = true; \
+        static const bool isSigned = static_cast<K>(-1) < static_cast<K>(0); \
+        typedef U bits; \
+    }
+
+SJTU_PRIORITY_QUEUE_INTEGER(char, unsigned char);
+SJTU_PRIORITY_QUEUE_INTEGER(signed char, unsigned char);
+SJTU_PRIORITY_QUEUE_INTEGER(unsigned char, unsigned char);
+SJTU_PRIORITY_QUEUE_INTEGER(short, unsigned short);
+SJTU_PRIORITY_QUEUE_INTEGER(unsigned short, unsigned short);
+SJTU_PRIORITY_QUEUE_INTEGER(int, unsigned int);
+SJTU_PRIORITY_QUEUE_INTEGER(unsigned int, unsigned int);
+SJTU_PRIORITY_QUEUE_INTEGER(long, unsigned long);
+SJTU_PRIORITY_QUEUE_INTEGER(unsigned long, unsigned long);
+SJTU_PRIORITY_QUEUE_INTEGER(long long, unsigned long long);
+SJTU_PRIORITY_QUEUE_INTEGER(unsigned long long, unsigned long long);
+
+#undef SJTU_PRIORITY_QUEUE_INTEGER
+
+template<bool B>
+struct flag {};
+
+}
+
 template<typename T, class Compare = std::less<T>>
 class priority_queue {
 private:
@@ -23,6 +84,32 @@ private:
     size_t curSize;
     Compare cmp;
 
+    // While frozen, the elements are split between sorted[sortedBegin,
+    // sortedEnd), best first, and a side heap at root that takes later
+    // pushes and merges. sideTop tells whether top() is root rather than
+    // sorted[sortedBegin]; the sorted part is released once it is drained.
+    // The sorted nodes are also kept linked as a left chain, each node's
+    // left child being the next one, so the sorted part is a leftist heap
+    // at sorted[sortedBegin] at all times and thaw() need not relink it.
+    Node **sorted;
+    size_t sortedBegin;
+    size_t sortedEnd;
+    bool sideTop;
+
+    // std::move and std::swap without <utility>, which this header may not
+    // include.
+    template<class V>
+    static V &&moveOut(V &x) {
+        return static_cast<V &&>(x);
+    }
+
+    template<class V>
+    static void exchange(V &a, V &b) {
+        V t = moveOut(a);
+        a = moveOut(b);
+        b = moveOut(t);
+    }
+
     // Helper function to calculate distance (null path length)
     int getDist(Node *node) const {
         return node ? node->dist : -1;
@@ -35,7 +122,7 @@ private:
 
         // Ensure h1 has the higher priority (larger value for max-heap)
         if (cmp(h1->data, h2->data)) {
-            std::swap(h1, h2);
+            exchange(h1, h2);
         }
 
         // h1 now has higher priority, recursively merge h1->right with h2
@@ -43,7 +130,7 @@ private:
 
         // Maintain leftist property: ensure left subtree has larger distance
         if (getDist(h1->left) < getDist(h1->right)) {
-            std::swap(h1->left, h1->right);
+            exchange(h1->left, h1->right);
         }
 
         // Update distance
@@ -52,43 +139,576 @@ private:
         return h1;
     }
 
-    // Copy subtree
-    Node* copyTree(Node *node) {
+    // A source subtree and the copy of its root, waiting for its children.
+    struct CopyStep {
+        const Node *from;
+        Node *to;
+    };
+
+    // Copy subtree. Walks left spines and stacks the right children, since
+    // a thawed or restored heap can be one long left chain.
+    static Node* copyTree(const Node *node) {
         if (!node) return nullptr;
 
-        Node *newNode = nullptr;
+        Node *newRoot = new Node(node->data);
+        newRoot->dist = node->dist;
         try {
-            newNode = new Node(node->data);
-            newNode->left = copyTree(node->left);
-            newNode->right = copyTree(node->right);
-            newNode->dist = node->dist;
+            NodeStack<CopyStep> pending;
+            pending.push(CopyStep{node, newRoot});
+            while (!pending.empty()) {
+                CopyStep next = pending.pop();
+                for (const Node *from = next.from; from; from = from->left) {
+                    Node *to = next.to;
+                    if (from->right) {
+                        to->right = new Node(from->right->data);
+                        to->right->dist = from->right->dist;
+                        pending.push(CopyStep{from->right, to->right});
+                    }
+                    if (from->left) {
+                        to->left = new Node(from->left->data);
+                        to->left->dist = from->left->dist;
+                        next.to = to->left;
+                    }
+                }
+            }
         } catch (...) {
-            delete newNode;
+            deleteTree(newRoot);
+            throw;
+        }
+        return newRoot;
+    }
+
+    // Delete subtree. Rotates left children onto the right spine instead
+    // of recursing, so long left chains (from sorted pushes or restoreTop) cannot
+    // exhaust the stack.
+    static void deleteTree(Node *node) {
+        while (node) {
+            if (node->left) {
+                Node *l = node->left;
+                node->left = l->right;
+                l->right = node;
+                node = l;
+            } else {
+                Node *r = node->right;
+                delete node;
+                node = r;
+            }
+        }
+    }
+
+    // Build a heap from [first, last) in O(n) by melding equal-sized heaps
+    // like a binary counter, instead of pushing elements one by one. Working
+    // depth-first keeps the recently touched nodes in cache.
+    template<class InputIt>
+    Node* buildTree(InputIt first, InputIt last, size_t &count) {
+        Node *heaps[sizeof(size_t) * 8 + 1];
+        size_t sizes[sizeof(size_t) * 8 + 1];
+        int top = 0;
+        count = 0;
+        try {
+            for (; first != last; ++first) {
+                heaps[top] = new Node(*first);
+                sizes[top++] = 1;
+                ++count;
+                while (top >= 2 && sizes[top - 1] == sizes[top - 2]) {
+                    heaps[top - 2] = mergeNodes(heaps[top - 2], heaps[top - 1]);
+                    sizes[top - 2] *= 2;
+                    --top;
+                }
+            }
+            while (top >= 2) {
+                heaps[top - 2] = mergeNodes(heaps[top - 2], heaps[top - 1]);
+                --top;
+            }
+        } catch (...) {
+            // A failed merge touches neither input, so every heap still on
+            // the stack is intact and owns its nodes.
+            while (top > 0) deleteTree(heaps[--top]);
+            throw;
+        }
+        return top ? heaps[0] : nullptr;
+    }
+
+    // Build [first, last) into the empty queue part: split the range in
+    // halves for depth levels, build the leaves on separate threads and
+    // meld the partial heaps back up the same tree. Every partial heap is a
+    // queue of its own, copied from part before the fork, so each thread
+    // compares with its own copy of Compare.
+    template<class Policy, class RandomIt>
+    static void buildPart(const Policy &policy, RandomIt first, RandomIt last, unsigned depth, priority_queue &part) {
+        if (depth == 0 || last - first < 2) {
+            part.root = part.buildTree(first, last, part.curSize);
+            return;
+        }
+
+        RandomIt mid = first + (last - first) / 2;
+        priority_queue left(part), right(part);
+        policy.fork_join([&]() { buildPart(policy, first, mid, depth - 1, left); },
+                         [&]() { buildPart(policy, mid, last, depth - 1, right); });
+        left.merge(right);
+        part.root = left.root;
+        part.curSize = left.curSize;
+        left.root = nullptr;
+        left.curSize = 0;
+    }
+
+    // Subtrees still to be visited by a scan or a copy, grown by doubling.
+    // They keep their own stack instead of recursing because the left spine
+    // of a leftist heap can be as long as the heap.
+    template<class Item = const Node *>
+    class NodeStack {
+        Item *items;
+        size_t count;
+        size_t capacity;
+
+    public:
+        NodeStack() : items(nullptr), count(0), capacity(0) {}
+        NodeStack(const NodeStack &) = delete;
+        NodeStack &operator=(const NodeStack &) = delete;
+
+        ~NodeStack() {
+            delete[] items;
+        }
+
+        bool empty() const {
+            return count == 0;
+        }
+
+        void push(const Item &item) {
+            if (count == capacity) {
+                size_t newCapacity = capacity ? 2 * capacity : 32;
+                Item *newItems = new Item[newCapacity];
+                for (size_t i = 0; i < count; ++i) newItems[i] = items[i];
+                delete[] items;
+                items = newItems;
+                capacity = newCapacity;
+            }
+            items[count++] = item;
+        }
+
+        Item pop() {
+            return items[--count];
+        }
+    };
+
+    // Call f on every element of the subtree, walking left spines and
+    // stacking the right children met on the way. A non-null stop on the
+    // left spine of node ends that spine early, leaving out stop's subtree.
+    template<class F>
+    static void visitTree(const Node *node, F &f, const Node *stop = nullptr) {
+        NodeStack<> pending;
+        while (true) {
+            for (; node && node != stop; node = node->left) {
+                f(node->data);
+                if (node->right) pending.push(node->right);
+            }
+            if (pending.empty()) return;
+            node = pending.pop();
+        }
+    }
+
+    // visitTree over the sorted part and the side heap.
+    template<class F>
+    void visitAll(F &f) const {
+        for (size_t i = sortedBegin; i < sortedEnd; ++i) f(sorted[i]->data);
+        visitTree(root, f);
+    }
+
+    void releaseSorted() {
+        for (size_t i = sortedBegin; i < sortedEnd; ++i) delete sorted[i];
+        delete[] sorted;
+        sorted = nullptr;
+        sortedBegin = sortedEnd = 0;
+        sideTop = false;
+    }
+
+    // pop() while frozen: take the better of the sorted front and the side
+    // heap's top, working out which one comes next before committing.
+    void popFrozen() {
+        try {
+            if (sideTop) {
+                Node *oldRoot = root;
+                Node *rest = mergeNodes(oldRoot->left, oldRoot->right);
+                bool restTop;
+                try {
+                    restTop = rest && cmp(sorted[sortedBegin]->data, rest->data);
+                } catch (...) {
+                    // Keep the melded children under the old root.
+                    oldRoot->left = rest;
+                    oldRoot->right = nullptr;
+                    oldRoot->dist = 0;
+                    throw;
+                }
+                root = rest;
+                delete oldRoot;
+                sideTop = restTop;
+            } else {
+                size_t next = sortedBegin + 1;
+                bool rootTop = root && (next == sortedEnd || cmp(sorted[next]->data, root->data));
+                delete sorted[sortedBegin];
+                sortedBegin = next;
+                sideTop = rootTop;
+                if (sortedBegin == sortedEnd) releaseSorted();
+            }
+            curSize--;
+        } catch (...) {
+            throw runtime_error();
+        }
+    }
+
+    // Sort nodes[0, n) best first. Integral keys under std::less or
+    // std::greater are radix sorted without calling Compare; anything else
+    // goes through a bottom-up merge sort. Either may leave the result in a
+    // fresh array, which then replaces nodes. If Compare throws, an
+    // insertion step may have been cut short, leaving nodes with a repeated
+    // entry and a missing one, so it must only be freed; the nodes and
+    // their links are never touched.
+    static const bool radixKeys = priority_queue_traits::integer<T>::value &&
+                                  (priority_queue_traits::same<Compare, std::less<T>>::value ||
+                                   priority_queue_traits::same<Compare, std::greater<T>>::value);
+
+    void sortBestFirst(Node **&nodes, size_t n) {
+        sortBestFirst(nodes, n, priority_queue_traits::flag<radixKeys>());
+    }
+
+    struct RadixItem {
+        unsigned long long key;
+        Node *node;
+    };
+
+    // Ascending keys are best first: the bits of x in sizeof(T) bytes with
+    // the sign bit flipped, complemented for a max-heap.
+    static unsigned long long radixKey(const T &x) {
+        typedef typename priority_queue_traits::integer<T>::bits U;
+        const unsigned bits = sizeof(T) * 8;
+        const unsigned long long mask = bits == 64 ? ~0ull : (1ull << (bits % 64)) - 1;
+        unsigned long long u = (unsigned long long)(U)x;
+        if (priority_queue_traits::integer<T>::isSigned) u ^= 1ull << (bits - 1);
+        return priority_queue_traits::same<Compare, std::less<T>>::value ? mask - u : u;
+    }
+
+    // LSD radix sort, one byte per pass, skipping bytes all keys share.
+    void sortBestFirst(Node **&nodes, size_t n, priority_queue_traits::flag<true>) {
+        RadixItem *items = new RadixItem[n];
+        RadixItem *buffer = nullptr;
+        try {
+            buffer = new RadixItem[n];
+        } catch (...) {
+            delete[] items;
+            throw;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            items[i].key = radixKey(nodes[i]->data);
+            items[i].node = nodes[i];
+        }
+        for (unsigned shift = 0; shift < sizeof(T) * 8; shift += 8) {
+            size_t count[256] = {};
+            for (size_t i = 0; i < n; ++i) ++count[items[i].key >> shift & 255];
+            if (count[items[0].key >> shift & 255] == n) continue;
+            size_t offset = 0;
+            for (unsigned d = 0; d < 256; ++d) {
+                size_t c = count[d];
+                count[d] = offset;
+                offset += c;
+            }
+            for (size_t i = 0; i < n; ++i) buffer[count[items[i].key >> shift & 255]++] = items[i];
+            exchange(items, buffer);
+        }
+        for (size_t i = 0; i < n; ++i) nodes[i] = items[i].node;
+        delete[] items;
+        delete[] buffer;
+    }
+
+    // Insertion sort of short runs, then merges of doubling width between
+    // nodes and a buffer.
+    void sortBestFirst(Node **&nodes, size_t n, priority_queue_traits::flag<false>) {
+        const size_t run = 16;
+        for (size_t lo = 0; lo < n; lo += run) {
+            size_t hi = lo + run < n ? lo + run : n;
+            for (size_t i = lo + 1; i < hi; ++i) {
+                Node *x = nodes[i];
+                size_t j = i;
+                for (; j > lo && cmp(nodes[j - 1]->data, x->data); --j) nodes[j] = nodes[j - 1];
+                nodes[j] = x;
+            }
+        }
+        if (n <= run) return;
+
+        Node **from = nodes;
+        Node **to = new Node *[n];
+        try {
+            for (size_t width = run; width < n; width *= 2) {
+                for (size_t lo = 0; lo < n; lo += 2 * width) {
+                    size_t mid = lo + width < n ? lo + width : n;
+                    size_t hi = lo + 2 * width < n ? lo + 2 * width : n;
+                    size_t i = lo, j = mid, k = lo;
+                    while (i < mid && j < hi) {
+                        to[k++] = cmp(from[i]->data, from[j]->data) ? from[j++] : from[i++];
+                    }
+                    while (i < mid) to[k++] = from[i++];
+                    while (j < hi) to[k++] = from[j++];
+                }
+                exchange(from, to);
+            }
+        } catch (...) {
+            // Hand back whichever array is still allocated.
+            if (from != nodes) {
+                delete[] nodes;
+                nodes = from;
+            } else {
+                delete[] to;
+            }
             throw;
         }
-        return newNode;
+        delete[] to;
+        nodes = from;
+    }
+
+    static const unsigned maxScanGroups = 64;
+
+    // Per-thread partial result, on its own cache line.
+    template<class V>
+    struct alignas(64) ScanSlot {
+        V value;
+    };
+
+    // A stretch [start, stop) of a left spine together with the right
+    // subtrees hanging off it, which is what visitTree(start, f, stop)
+    // visits. weight estimates its size: one per spine node plus
+    // 2^(d+1) - 1 for a right child of dist d, the least such a subtree
+    // holds.
+    struct ScanPart {
+        const Node *start;
+        const Node *stop;
+        size_t length;  // spine nodes
+        size_t weight;
+    };
+
+    static size_t spineWeight(const Node *x) {
+        if (!x->right) return 1;
+        int d = x->right->dist;
+        return d < 60 ? ((size_t)2 << d) : (size_t)1 << 61;
+    }
+
+    static ScanPart wholeSpine(const Node *start) {
+        ScanPart part = {start, nullptr, 0, 0};
+        for (const Node *x = start; x; x = x->left) {
+            ++part.length;
+            part.weight += spineWeight(x);
+        }
+        return part;
     }
 
-    // Delete subtree
-    void deleteTree(Node *node) {
-        if (!node) return;
-        deleteTree(node->left);
-        deleteTree(node->right);
-        delete node;
+    // The tree cut into disjoint parts for a parallel scan: the parts, and
+    // the nodes taken out between them in opened. The heaviest part is cut
+    // next. A stretch of several spine nodes is cut, in one walk, into
+    // pieces of about equal weight, as many as its share of the total
+    // weight earns it; a single spine node is opened and its right subtree
+    // becomes a part. Cutting spines, not only opening subtrees, keeps the
+    // parts even on long left chains (after thaw() or restoreTop()), where
+    // every dist is 0. Elsewhere the weights are only lower bounds, and a
+    // subtree of small dist can be large, so the parts of a random heap can
+    // still differ severalfold.
+    struct TopSplit {
+        ScanPart *parts;
+        const Node **opened;
+        size_t partCount;
+        size_t openedCount;
+
+        TopSplit(const Node *root, size_t want) : parts(nullptr), opened(nullptr), partCount(0), openedCount(0) {
+            size_t maxOpened = 2 * want;
+            parts = new ScanPart[want];
+            try {
+                opened = new const Node *[maxOpened];
+            } catch (...) {
+                delete[] parts;
+                throw;
+            }
+            if (root) parts[partCount++] = wholeSpine(root);
+            size_t total = partCount ? parts[0].weight : 0;
+            while (partCount > 0 && partCount < want && openedCount < maxOpened) {
+                size_t best = 0;
+                for (size_t i = 1; i < partCount; ++i) {
+                    if (parts[i].weight > parts[best].weight) best = i;
+                }
+                ScanPart part = parts[best];
+                if (part.length == 1) {
+                    if (!part.start->right) break;  // every part is a single node
+                    opened[openedCount++] = part.start;
+                    parts[best] = wholeSpine(part.start->right);
+                    total = total - part.weight + parts[best].weight;
+                    continue;
+                }
+                size_t pieces = (want - partCount) * part.weight / total + 1;
+                if (pieces < 2) pieces = 2;
+                if (pieces > part.length) pieces = part.length;
+                if (pieces > want - partCount + 1) pieces = want - partCount + 1;
+                const Node *x = part.start;
+                size_t length = 0, weight = 0;
+                for (size_t k = 1; k < pieces; ++k) {
+                    ScanPart piece = {x, nullptr, 0, 0};
+                    do {
+                        piece.weight += spineWeight(x);
+                        ++piece.length;
+                        x = x->left;
+                    } while (part.length - length - piece.length > pieces - k &&
+                             (weight + piece.weight) * pieces < k * part.weight);
+                    piece.stop = x;
+                    length += piece.length;
+                    weight += piece.weight;
+                    if (k == 1) parts[best] = piece;
+                    else parts[partCount++] = piece;
+                }
+                ScanPart last = {x, part.stop, part.length - length, part.weight - weight};
+                parts[partCount++] = last;
+            }
+        }
+
+        TopSplit(const TopSplit &) = delete;
+        TopSplit &operator=(const TopSplit &) = delete;
+
+        ~TopSplit() {
+            delete[] parts;
+            delete[] opened;
+        }
+    };
+
+    // Split the tree for concurrency() threads and run scan(group, f) on
+    // every group through the policy's fork_join: group g visits every
+    // part whose index is g modulo the number of groups, and group 0 also
+    // the opened nodes above the cut. makeVisitor(g) returns the callable
+    // that group g passes elements to.
+    template<class Policy, class MakeVisitor>
+    unsigned scanGroups(const Policy &policy, MakeVisitor makeVisitor) const {
+        unsigned groups = policy.concurrency();
+        if (groups > maxScanGroups) groups = maxScanGroups;
+        if (groups == 0) groups = 1;
+        TopSplit split(root, 4 * groups);
+        auto scan = [&](unsigned g) {
+            auto &&visit = makeVisitor(g);
+            if (g == 0) {
+                for (size_t i = 0; i < split.openedCount; ++i) visit(split.opened[i]->data);
+            }
+            for (size_t i = g; i < split.partCount; i += groups) visitTree(split.parts[i].start, visit, split.parts[i].stop);
+            size_t n = sortedEnd - sortedBegin;
+            for (size_t i = sortedBegin + n * g / groups; i < sortedBegin + n * (g + 1) / groups; ++i) {
+                visit(sorted[i]->data);
+            }
+        };
+        forkGroups(policy, 0, groups, scan);
+        return groups;
+    }
+
+    template<class Policy, class Scan>
+    static void forkGroups(const Policy &policy, unsigned lo, unsigned hi, Scan &scan) {
+        if (hi - lo == 1) {
+            scan(lo);
+            return;
+        }
+        unsigned mid = lo + (hi - lo) / 2;
+        policy.fork_join([&]() { forkGroups(policy, lo, mid, scan); },
+                         [&]() { forkGroups(policy, mid, hi, scan); });
+    }
+
+    // batch_priority_queue pops candidates off its shards and puts back the
+    // ones it did not select; these two let it do that without copying,
+    // allocating or comparing. Its shards are never frozen.
+    template<typename, class>
+    friend class batch_priority_queue;
+
+    // Unlink the top node and hand it to the caller.
+    Node* detachTop() {
+        Node *oldRoot = root;
+        Node *rest;
+        try {
+            rest = mergeNodes(oldRoot->left, oldRoot->right);
+        } catch (...) {
+            throw runtime_error();
+        }
+        root = rest;
+        curSize--;
+        oldRoot->left = oldRoot->right = nullptr;
+        oldRoot->dist = 0;
+        return oldRoot;
+    }
+
+    // Put back nodes[0, count), detached in that order by detachTop() with
+    // nothing pushed since, as a left chain above the root. That is a valid
+    // leftist heap, so Compare is not called.
+    void restoreTop(Node *const *nodes, size_t count) {
+        if (count == 0) return;
+        for (size_t i = 0; i < count; ++i) {
+            nodes[i]->left = i + 1 < count ? nodes[i + 1] : root;
+            nodes[i]->right = nullptr;
+            nodes[i]->dist = 0;
+        }
+        root = nodes[0];
+        curSize += count;
     }
 
 public:
     /**
      * @brief default constructor
      */
-    priority_queue() : root(nullptr), curSize(0), cmp() {}
+    priority_queue() : root(nullptr), curSize(0), cmp(), sorted(nullptr), sortedBegin(0), sortedEnd(0), sideTop(false) {}
+
+    /**
+     * @brief construct from the elements of [first, last) in O(n).
+     * @throws runtime_error if Compare throws
+     */
+    template<class InputIt>
+    priority_queue(InputIt first, InputIt last)
+        : root(nullptr), curSize(0), cmp(), sorted(nullptr), sortedBegin(0), sortedEnd(0), sideTop(false) {
+        try {
+            root = buildTree(first, last, curSize);
+        } catch (...) {
+            throw runtime_error();
+        }
+    }
+
+    /**
+     * @brief construct from [first, last) using the threads of an execution
+     * policy (see execution.hpp), e.g. priority_queue(sjtu::execution::par, b, e).
+     * Each thread builds a leftist heap of its slice from its own nodes with
+     * its own copy of Compare, and the partial heaps are melded in a
+     * balanced reduction.
+     * @throws runtime_error if Compare throws
+     */
+    template<class Policy, class RandomIt,
+             class = typename priority_queue_traits::policy_tag<Policy>::type>
+    priority_queue(Policy &&policy, RandomIt first, RandomIt last)
+        : root(nullptr), curSize(0), cmp(), sorted(nullptr), sortedBegin(0), sortedEnd(0), sideTop(false) {
+        unsigned depth = 0;
+        while ((1u << depth) < policy.concurrency()) ++depth;
+        try {
+            buildPart(policy, first, last, depth, *this);
+        } catch (...) {
+            throw runtime_error();
+        }
+    }
 
     /**
      * @brief copy constructor
      * @param other the priority_queue to be copied
      */
-    priority_queue(const priority_queue &other) : curSize(other.curSize), cmp(other.cmp) {
+    priority_queue(const priority_queue &other)
+        : root(nullptr), curSize(other.curSize), cmp(other.cmp), sorted(nullptr), sortedBegin(0), sortedEnd(0),
+          sideTop(other.sideTop) {
         root = copyTree(other.root);
+        if (!other.sorted) return;
+
+        try {
+            sorted = new Node *[other.sortedEnd - other.sortedBegin];
+            for (size_t i = other.sortedBegin; i < other.sortedEnd; ++i) {
+                sorted[sortedEnd] = new Node(other.sorted[i]->data);
+                if (sortedEnd > 0) sorted[sortedEnd - 1]->left = sorted[sortedEnd];
+                ++sortedEnd;
+            }
+        } catch (...) {
+            releaseSorted();
+            deleteTree(root);
+            throw;
+        }
     }
 
     /**
@@ -96,6 +716,7 @@ public:
      */
     ~priority_queue() {
         deleteTree(root);
+        releaseSorted();
     }
 
     /**
@@ -106,16 +727,15 @@ public:
     priority_queue &operator=(const priority_queue &other) {
         if (this == &other) return *this;
 
-        // Create a copy first for exception safety
-        Node *newRoot = copyTree(other.root);
-        size_t newSize = other.curSize;
-        Compare newCmp = other.cmp;
-
-        // If copy succeeded, replace current state
-        deleteTree(root);
-        root = newRoot;
-        curSize = newSize;
-        cmp = newCmp;
+        // Create a copy first for exception safety, then take over its state
+        priority_queue copy(other);
+        exchange(root, copy.root);
+        exchange(curSize, copy.curSize);
+        exchange(cmp, copy.cmp);
+        exchange(sorted, copy.sorted);
+        exchange(sortedBegin, copy.sortedBegin);
+        exchange(sortedEnd, copy.sortedEnd);
+        exchange(sideTop, copy.sideTop);
 
         return *this;
     }
@@ -129,7 +749,7 @@ public:
         if (empty()) {
             throw container_is_empty();
         }
-        return root->data;
+        return sorted && !sideTop ? sorted[sortedBegin]->data : root->data;
     }
 
     /**
@@ -137,14 +757,21 @@ public:
      * @param e the element to be pushed
      */
     void push(const T &e) {
+        Node *newNode = nullptr;
         try {
-            Node *newNode = new Node(e);
+            newNode = new Node(e);
+
+            // While frozen the new element joins the side heap, and becomes
+            // the top if it beats the sorted front.
+            bool newTop = sorted && !sideTop && cmp(sorted[sortedBegin]->data, e);
 
-            // Use merge to insert - note this may not be fully exception-safe
-            // but provides the required O(log n) complexity
+            // A failed merge leaves root untouched, so only the new node
+            // has to be released
             root = mergeNodes(root, newNode);
             curSize++;
+            sideTop = sideTop || newTop;
         } catch (...) {
+            delete newNode;
             throw runtime_error();
         }
     }
@@ -157,6 +784,10 @@ public:
         if (empty()) {
             throw container_is_empty();
         }
+        if (sorted) {
+            popFrozen();
+            return;
+        }
 
         try {
             Node *oldRoot = root;
@@ -190,15 +821,21 @@ public:
     /**
      * @brief merge another priority_queue into this one.
      * The other priority_queue will be cleared after merging.
-     * The complexity is at most O(logn).
+     * The complexity is at most O(logn), including the thaw() of other if
+     * it is frozen; a frozen queue takes other into its side heap.
      * @param other the priority_queue to be merged.
+     * @throws runtime_error if Compare throws; this queue is unchanged and
+     * other keeps all its elements, but a frozen other may come back thawed.
      */
     void merge(priority_queue &other) {
         if (this == &other) return;
 
+        other.thaw();
         try {
+            bool newTop = sorted && !sideTop && other.root && cmp(sorted[sortedBegin]->data, other.root->data);
             root = mergeNodes(root, other.root);
             curSize += other.curSize;
+            sideTop = sideTop || newTop;
 
             // Clear other queue
             other.root = nullptr;
@@ -207,6 +844,184 @@ public:
             throw runtime_error();
         }
     }
+
+    /**
+     * @brief switch to a read-optimised layout for a phase that mostly
+     * pops: every element moves into an array sorted best first, where
+     * top() and pop() are O(1) index moves. Costs O(n log n) comparisons,
+     * or O(n) without any for integral T under std::less / std::greater.
+     * Later push() and merge() go to a small side heap, so the queue stays
+     * frozen until the sorted part is drained or thaw() is called. Freezing
+     * a frozen queue sorts its side heap and merges it with the sorted part.
+     * @throws runtime_error if Compare throws; the queue is unchanged, and
+     * still frozen if it was.
+     */
+    void freeze() {
+        if (!root) return;
+
+        // Nothing is relinked until both arrays are complete.
+        Node **nodes = nullptr;
+        Node **all = nullptr;
+        try {
+            // Gather the side heap breadth first, using the array as the queue.
+            size_t count = 0;
+            nodes = new Node *[curSize - (sortedEnd - sortedBegin)];
+            nodes[count++] = root;
+            for (size_t i = 0; i < count; ++i) {
+                if (nodes[i]->left) nodes[count++] = nodes[i]->left;
+                if (nodes[i]->right) nodes[count++] = nodes[i]->right;
+            }
+            sortBestFirst(nodes, count);
+            if (sorted) {
+                all = new Node *[curSize];
+                size_t i = sortedBegin, j = 0, k = 0;
+                while (i < sortedEnd && j < count) {
+                    all[k++] = cmp(sorted[i]->data, nodes[j]->data) ? nodes[j++] : sorted[i++];
+                }
+                while (i < sortedEnd) all[k++] = sorted[i++];
+                while (j < count) all[k++] = nodes[j++];
+                delete[] nodes;
+                nodes = all;
+                all = nullptr;
+            }
+        } catch (...) {
+            delete[] nodes;
+            delete[] all;
+            throw runtime_error();
+        }
+        delete[] sorted;
+        for (size_t i = 0; i < curSize; ++i) {
+            nodes[i]->left = i + 1 < curSize ? nodes[i + 1] : nullptr;
+            nodes[i]->right = nullptr;
+            nodes[i]->dist = 0;
+        }
+        sorted = nodes;
+        sortedBegin = 0;
+        sortedEnd = curSize;
+        sideTop = false;
+        root = nullptr;
+    }
+
+    /**
+     * @brief leave the frozen layout. The sorted part is already linked as
+     * a left chain, which is a valid leftist heap, so it is melded with the
+     * side heap in O(log n). Does nothing if not frozen.
+     * @throws runtime_error if Compare throws; the queue is unchanged.
+     */
+    void thaw() {
+        if (!sorted) return;
+
+        try {
+            root = mergeNodes(sorted[sortedBegin], root);
+        } catch (...) {
+            throw runtime_error();
+        }
+        delete[] sorted;
+        sorted = nullptr;
+        sortedBegin = sortedEnd = 0;
+        sideTop = false;
+    }
+
+    /**
+     * @brief whether the queue is in the layout made by freeze().
+     */
+    bool is_frozen() const {
+        return sorted != nullptr;
+    }
+
+    /**
+     * @brief call f(const T &) on every element, in no particular order.
+     * The scans below never modify, copy or reorder the heap, and do not
+     * call Compare. Exceptions thrown by f propagate unchanged.
+     * @return f
+     */
+    template<class F>
+    F for_each(F f) const {
+        visitAll(f);
+        return f;
+    }
+
+    /**
+     * @brief for_each split across the threads of an execution policy (see
+     * execution.hpp); f is called concurrently from several threads.
+     */
+    template<class Policy, class F,
+             class = typename priority_queue_traits::policy_tag<Policy>::type>
+    void for_each(Policy &&policy, F f) const {
+        scanGroups(policy, [&f](unsigned) -> F & { return f; });
+    }
+
+    /**
+     * @brief number of elements satisfying pred.
+     */
+    template<class Predicate>
+    size_t count_if(Predicate pred) const {
+        size_t count = 0;
+        auto visit = [&](const T &x) {
+            if (pred(x)) ++count;
+        };
+        visitAll(visit);
+        return count;
+    }
+
+    /**
+     * @brief count_if split across the threads of an execution policy;
+     * pred is called concurrently from several threads.
+     */
+    template<class Policy, class Predicate,
+             class = typename priority_queue_traits::policy_tag<Policy>::type>
+    size_t count_if(Policy &&policy, Predicate pred) const {
+        ScanSlot<size_t> counts[maxScanGroups] = {};
+        unsigned groups = scanGroups(policy, [&](unsigned g) {
+            return [&pred, &counts, g](const T &x) {
+                if (pred(x)) ++counts[g].value;
+            };
+        });
+        size_t count = 0;
+        for (unsigned g = 0; g < groups; ++g) count += counts[g].value;
+        return count;
+    }
+
+    /**
+     * @brief fold every element into init with acc = op(acc, x), in no
+     * particular order, so op should be associative and commutative.
+     */
+    template<class U, class BinaryOp>
+    U reduce(U init, BinaryOp op) const {
+        auto visit = [&](const T &x) {
+            init = op(moveOut(init), x);
+        };
+        visitAll(visit);
+        return init;
+    }
+
+    /**
+     * @brief reduce split across the threads of an execution policy. Each
+     * thread folds its part into a value-initialised U with op, and the
+     * partial results are folded into init with combine, so U() must be
+     * an identity of combine (0 for sums, an empty histogram, ...).
+     */
+    template<class Policy, class U, class BinaryOp, class Combine,
+             class = typename priority_queue_traits::policy_tag<Policy>::type>
+    U reduce(Policy &&policy, U init, BinaryOp op, Combine combine) const {
+        ScanSlot<U> partials[maxScanGroups] = {};
+        unsigned groups = scanGroups(policy, [&](unsigned g) {
+            return [&op, &partials, g](const T &x) {
+                partials[g].value = op(moveOut(partials[g].value), x);
+            };
+        });
+        for (unsigned g = 0; g < groups; ++g) init = combine(moveOut(init), moveOut(partials[g].value));
+        return init;
+    }
+
+    /**
+     * @brief parallel reduce where op also combines two partial results.
+     */
+    template<class Policy, class U, class BinaryOp,
+             class = typename priority_queue_traits::policy_tag<Policy>::type>
+    U reduce(Policy &&policy, U init, BinaryOp op) const {
+        return reduce(policy, moveOut(init), op, op);
+    }
 };
 
 }
@@ -0,0 +1,178 @@
+#ifndef SJTU_PRIORITY_QUEUE_KV_HPP
+#define SJTU_PRIORITY_QUEUE_KV_HPP
+
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <utility>
+#include "exceptions.hpp"
+#include "leftist_tree.hpp"
+#include "utility.hpp"
+
+namespace sjtu {
+
+/**
+ * A leftist-heap priority queue of sjtu::pair<Key, Value> ordered by the key
+ * alone. emplace() builds the pair directly inside the heap node, so the
+ * payload is never copied on its way in.
+ */
+template<typename Key, typename Value, class KeyCompare = std::less<Key>>
+class priority_queue_kv {
+public:
+    using value_type = pair<Key, Value>;
+
+private:
+    struct Node {
+        value_type data;
+        Node *left;
+        Node *right;
+        int dist;  // null path length for leftist heap
+
+        template<class... Args>
+        explicit Node(Args &&...args) : data(std::forward<Args>(args)...), left(nullptr), right(nullptr), dist(0) {}
+    };
+
+    Node *root;
+    size_t curSize;
+    KeyCompare cmp;
+
+    using tree = leftist_tree<Node>;
+
+    struct keyBefore {
+        KeyCompare &cmp;
+        bool operator()(const Node *a, const Node *b) const {
+            return cmp(a->data.first, b->data.first);
+        }
+    };
+
+    Node *mergeNodes(Node *h1, Node *h2) {
+        return tree::merge(h1, h2, keyBefore{cmp});
+    }
+
+    // Takes ownership of newNode, freeing it if the merge fails.
+    void pushNode(Node *newNode) {
+        try {
+            root = mergeNodes(root, newNode);
+        } catch (...) {
+            delete newNode;
+            throw runtime_error();
+        }
+        curSize++;
+    }
+
+    static Node *copyTree(const Node *node) {
+        return tree::copy(node, [](const Node *x) { return new Node(x->data); });
+    }
+
+public:
+    /**
+     * @brief default constructor
+     */
+    priority_queue_kv() : root(nullptr), curSize(0), cmp() {}
+
+    /**
+     * @brief copy constructor
+     */
+    priority_queue_kv(const priority_queue_kv &other) : root(nullptr), curSize(other.curSize), cmp(other.cmp) {
+        root = copyTree(other.root);
+    }
+
+    ~priority_queue_kv() {
+        tree::destroy(root);
+    }
+
+    priority_queue_kv &operator=(const priority_queue_kv &other) {
+        if (this == &other) return *this;
+
+        Node *newRoot = copyTree(other.root);
+        tree::destroy(root);
+        root = newRoot;
+        curSize = other.curSize;
+        cmp = other.cmp;
+
+        return *this;
+    }
+
+    /**
+     * @brief the pair with the largest key.
+     * @throws container_is_empty if empty() returns true
+     */
+    const value_type &top() const {
+        if (empty()) {
+            throw container_is_empty();
+        }
+        return root->data;
+    }
+
+    /**
+     * @throws runtime_error if KeyCompare throws; the queue is unchanged.
+     */
+    void push(const value_type &e) {
+        pushNode(new Node(e));
+    }
+
+    void push(value_type &&e) {
+        pushNode(new Node(std::move(e)));
+    }
+
+    /**
+     * @brief construct pair(key, Value(args...)) in place.
+     * @throws runtime_error if KeyCompare throws; the queue is unchanged.
+     */
+    template<class K, class... Args>
+    void emplace(K &&key, Args &&...args) {
+        pushNode(new Node(std::piecewise_construct,
+                          std::forward_as_tuple(std::forward<K>(key)),
+                          std::forward_as_tuple(std::forward<Args>(args)...)));
+    }
+
+    /**
+     * @brief delete the pair with the largest key.
+     * @throws container_is_empty if empty() returns true
+     * @throws runtime_error if KeyCompare throws; the queue is unchanged.
+     */
+    void pop() {
+        if (empty()) {
+            throw container_is_empty();
+        }
+
+        Node *newRoot;
+        try {
+            newRoot = mergeNodes(root->left, root->right);
+        } catch (...) {
+            throw runtime_error();
+        }
+        delete root;
+        root = newRoot;
+        curSize--;
+    }
+
+    size_t size() const {
+        return curSize;
+    }
+
+    bool empty() const {
+        return curSize == 0;
+    }
+
+    /**
+     * @brief merge another queue into this one in O(log n); other is cleared.
+     * @throws runtime_error if KeyCompare throws; both queues are unchanged.
+     */
+    void merge(priority_queue_kv &other) {
+        if (this == &other) return;
+
+        try {
+            root = mergeNodes(root, other.root);
+        } catch (...) {
+            throw runtime_error();
+        }
+        curSize += other.curSize;
+        other.root = nullptr;
+        other.curSize = 0;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,366 @@
+#ifndef SJTU_SOFT_HEAP_HPP
+#define SJTU_SOFT_HEAP_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * A soft heap (Chazelle; in the simplified form of Kaplan, Tarjan and Zwick)
+ * with error rate epsilon. Several elements may share one node and travel
+ * under a common "current key" that is no larger than any of their own keys;
+ * an element whose current key is strictly smaller than its key is
+ * corrupted. At any time at most epsilon * (number of insertions) elements
+ * are corrupted.
+ *
+ * In return insert() is O(1) amortized and meld() is O(log n). pop() is
+ * O(log n) amortized: refilling the node it took from is O(log 1/epsilon)
+ * amortized, but the root with the largest current key is then found again
+ * by rescanning up to log n roots. top() is the element with the largest
+ * current key, which is exact unless top_corrupted().
+ *
+ * Unlike priority_queue, a throwing Compare is not rolled back; the heap
+ * must be discarded after such a failure. It still owns every element, so
+ * destroying it frees them all.
+ */
+template<typename T, class Compare = std::less<T>>
+class soft_heap {
+private:
+    struct Item {
+        T data;
+        Item *next;
+
+        Item(const T &val) : data(val), next(nullptr) {}
+    };
+
+    struct Node {
+        T ckey;  // current key, <= the key of every item below
+        Item *head;
+        Item *tail;
+        size_t count;
+        int rank;
+        Node *left;
+        Node *right;
+
+        Node(Item *item) : ckey(item->data), head(item), tail(item), count(1), rank(0), left(nullptr), right(nullptr) {}
+        Node(Node *a, Node *b)
+            : ckey(a->ckey), head(nullptr), tail(nullptr), count(0), rank(a->rank + 1), left(a), right(b) {}
+    };
+
+    static const int maxRank = 64;
+
+    Node *roots[maxRank];      // roots[k] has rank k or is null
+    int best[maxRank + 1];     // best[k]: rank of the root with the largest ckey among ranks >= k, or -1
+    size_t targets[maxRank];   // how many items a node of each rank collects before it stops pulling
+    size_t curSize;
+    Compare cmp;
+
+    // Fill x up to its target by repeatedly pulling the item list of the
+    // child with the larger current key, refilling that child in turn.
+    void sift(Node *x) {
+        while (x->count < targets[x->rank] && (x->left || x->right)) {
+            if (!x->left || (x->right && cmp(x->left->ckey, x->right->ckey))) {
+                std::swap(x->left, x->right);
+            }
+            Node *c = x->left;
+            if (x->tail) x->tail->next = c->head;
+            else x->head = c->head;
+            x->tail = c->tail;
+            x->count += c->count;
+            x->ckey = c->ckey;
+            c->head = c->tail = nullptr;
+            c->count = 0;
+            if (!c->left && !c->right) {
+                delete c;
+                x->left = nullptr;
+            } else {
+                sift(c);
+            }
+        }
+    }
+
+    void updateBest(int from) {
+        for (int k = from; k >= 0; --k) {
+            int next = best[k + 1];
+            if (!roots[k]) best[k] = next;
+            else if (next < 0 || !cmp(roots[k]->ckey, roots[next]->ckey)) best[k] = k;
+            else best[k] = next;
+        }
+    }
+
+    // Add a tree of rank k to the root array, linking equal ranks like a
+    // binary counter, and set carry to null once the array owns it.
+    // If a link fails before carry is linked, carry still belongs to the
+    // caller; after that, the tree being built is parked in a slot the
+    // counter has emptied, so the destructor can still reach it.
+    // @return the highest rank touched
+    int addTree(Node *&carry, int k) {
+        Node *tree = carry;
+        while (roots[k]) {
+            Node *z;
+            try {
+                z = new Node(roots[k], tree);
+            } catch (...) {
+                if (!carry) roots[k - 1] = tree;
+                throw;
+            }
+            roots[k] = nullptr;
+            carry = nullptr;
+            try {
+                sift(z);
+            } catch (...) {
+                roots[k] = z;
+                throw;
+            }
+            tree = z;
+            ++k;
+        }
+        roots[k] = tree;
+        carry = nullptr;
+        return k;
+    }
+
+    static void deleteNode(Node *x) {
+        while (x->head) {
+            Item *next = x->head->next;
+            delete x->head;
+            x->head = next;
+        }
+        if (x->left) deleteNode(x->left);
+        if (x->right) deleteNode(x->right);
+        delete x;
+    }
+
+    template<class F>
+    static void visitNode(const Node *x, F &f) {
+        for (const Item *it = x->head; it; it = it->next) f(x->ckey, it->data);
+        if (x->left) visitNode(x->left, f);
+        if (x->right) visitNode(x->right, f);
+    }
+
+public:
+    /**
+     * @param epsilon error rate in (0, 1/2]
+     */
+    explicit soft_heap(double epsilon = 0.125, const Compare &c = Compare()) : curSize(0), cmp(c) {
+        if (!(epsilon > 0)) epsilon = 1e-9;
+        int threshold = (int)std::ceil(std::log2(1 / epsilon)) + 5;
+        size_t target = 1;
+        for (int k = 0; k < maxRank; ++k) {
+            if (k > threshold && target < ((size_t)-1) / 2) target = (3 * target + 1) / 2;
+            targets[k] = target;
+            roots[k] = nullptr;
+            best[k] = -1;
+        }
+        best[maxRank] = -1;
+    }
+
+    soft_heap(const soft_heap &) = delete;
+    soft_heap &operator=(const soft_heap &) = delete;
+
+    ~soft_heap() {
+        for (int k = 0; k < maxRank; ++k) {
+            if (roots[k]) deleteNode(roots[k]);
+        }
+    }
+
+    /**
+     * @brief the element with the largest current key.
+     * @throws container_is_empty if empty() returns true
+     */
+    const T &top() const {
+        if (empty()) {
+            throw container_is_empty();
+        }
+        return roots[best[0]]->head->data;
+    }
+
+    /**
+     * @brief whether top() has been corrupted, i.e. its key is larger than
+     * the key it is currently ranked by.
+     * @throws container_is_empty if empty() returns true
+     */
+    bool top_corrupted() const {
+        if (empty()) {
+            throw container_is_empty();
+        }
+        const Node *x = roots[best[0]];
+        return cmp(x->ckey, x->head->data);
+    }
+
+    /**
+     * @brief insert e in O(1) amortized.
+     */
+    void insert(const T &e) {
+        Item *item = new Item(e);
+        Node *x;
+        try {
+            x = new Node(item);
+        } catch (...) {
+            delete item;
+            throw;
+        }
+        int k;
+        try {
+            k = addTree(x, 0);
+        } catch (...) {
+            if (x) deleteNode(x);
+            throw;
+        }
+        ++curSize;
+        updateBest(k);
+    }
+
+    void push(const T &e) {
+        insert(e);
+    }
+
+    /**
+     * @brief delete top() in O(log n) amortized.
+     * @throws container_is_empty if empty() returns true
+     */
+    void pop() {
+        if (empty()) {
+            throw container_is_empty();
+        }
+
+        int k = best[0];
+        Node *x = roots[k];
+        Item *item = x->head;
+        x->head = item->next;
+        if (!x->head) x->tail = nullptr;
+        --x->count;
+        delete item;
+        --curSize;
+
+        if (x->count == 0) {
+            if (!x->left && !x->right) {
+                delete x;
+                roots[k] = nullptr;
+            } else {
+                sift(x);
+            }
+        }
+        updateBest(k);
+    }
+
+    /**
+     * @brief move every element of other into this heap; other is cleared.
+     * O(log n): the root arrays are added like binary counters.
+     */
+    void meld(soft_heap &other) {
+        if (this == &other) return;
+
+        int top = -1;
+        for (int k = 0; k < maxRank; ++k) {
+            if (other.roots[k]) {
+                top = std::max(top, addTree(other.roots[k], k));
+            }
+            other.best[k] = -1;
+        }
+        curSize += other.curSize;
+        other.curSize = 0;
+        if (top >= 0) updateBest(top);
+    }
+
+    void merge(soft_heap &other) {
+        meld(other);
+    }
+
+    size_t size() const {
+        return curSize;
+    }
+
+    bool empty() const {
+        return curSize == 0;
+    }
+
+    /**
+     * @brief call f(element) for every corrupted element, in O(n).
+     */
+    template<class F>
+    void for_each_corrupted(F f) const {
+        auto visit = [this, &f](const T &ckey, const T &data) {
+            if (cmp(ckey, data)) f(data);
+        };
+        for (int k = 0; k < maxRank; ++k) {
+            if (roots[k]) visitNode(roots[k], visit);
+        }
+    }
+
+    size_t corrupted_count() const {
+        size_t n = 0;
+        for_each_corrupted([&n](const T &) { ++n; });
+        return n;
+    }
+};
+
+/**
+ * @brief rearrange [first, last) like std::nth_element: *nth becomes the
+ * element that would be there if the range were sorted by cmp, with no
+ * element of [first, nth) greater and none of (nth, last) smaller.
+ *
+ * Each round inserts the range into a soft heap with epsilon = 1/3 and pops
+ * a third of it. The smallest popped element is a pivot whose rank lies
+ * between n/3 and 2n/3, so a three-way partition discards at least a third
+ * of the range. A round costs O(n) for the inserts and the partition but
+ * O(n log n) for its n/3 pops, since pop() is O(log n), so the selection
+ * runs in O(n log n) worst case, not Chazelle's O(n); it still never
+ * degrades the way a quickselect with bad pivots can.
+ */
+template<class RandomIt, class Compare>
+void soft_select(RandomIt first, RandomIt nth, RandomIt last, Compare cmp) {
+    struct IndexCompare {
+        RandomIt base;
+        Compare *cmp;
+        bool operator()(size_t a, size_t b) const {
+            return (*cmp)(base[a], base[b]);
+        }
+    };
+
+    while (last - first > 32) {
+        size_t n = last - first;
+        size_t pivot;
+        {
+            soft_heap<size_t, IndexCompare> heap(1.0 / 3, IndexCompare{first, &cmp});
+            for (size_t i = 0; i < n; ++i) heap.insert(i);
+            pivot = heap.top();
+            for (size_t i = 0; i < n / 3; ++i) {
+                if (cmp(first[heap.top()], first[pivot])) pivot = heap.top();
+                heap.pop();
+            }
+        }
+
+        std::iter_swap(first, first + pivot);
+        // Dutch national flag: [first, lt) < p, [lt, i) == p, [gt, last) > p
+        RandomIt lt = first, i = first + 1, gt = last;
+        while (i < gt) {
+            if (cmp(*i, *lt)) {
+                std::iter_swap(i++, lt++);
+            } else if (cmp(*lt, *i)) {
+                std::iter_swap(i, --gt);
+            } else {
+                ++i;
+            }
+        }
+        if (nth < lt) last = lt;
+        else if (nth >= gt) first = gt;
+        else return;
+    }
+    std::sort(first, last, cmp);
+}
+
+template<class RandomIt>
+void soft_select(RandomIt first, RandomIt nth, RandomIt last) {
+    soft_select(first, nth, last, std::less<typename std::iterator_traits<RandomIt>::value_type>());
+}
+
+}
+
+#endif
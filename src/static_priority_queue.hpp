@@ -0,0 +1,106 @@
+#ifndef SJTU_STATIC_PRIORITY_QUEUE_HPP
+#define SJTU_STATIC_PRIORITY_QUEUE_HPP
+
+#include <cstddef>
+#include <functional>
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * A binary heap in a fixed array of Capacity elements. Nothing in it
+ * allocates, so every operation is constexpr and the queue can be used inside
+ * constant evaluation (constexpr or consteval functions) to build tables at
+ * compile time. T must be a literal type with a default constructor, and
+ * Compare must be usable in constant expressions (std::less is).
+ *
+ * Like priority_queue, top() is the largest element with respect to Compare.
+ * Compare is assumed not to throw: there is nothing to roll back at compile
+ * time, so a failed push or pop is not undone.
+ */
+template<typename T, size_t Capacity, class Compare = std::less<T>>
+class static_priority_queue {
+private:
+    T data[Capacity == 0 ? 1 : Capacity];
+    size_t curSize;
+    Compare cmp;
+
+    static constexpr void swapElements(T &a, T &b) {
+        T tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    constexpr void siftUp(size_t i) {
+        while (i > 0) {
+            size_t parent = (i - 1) / 2;
+            if (!cmp(data[parent], data[i])) break;
+            swapElements(data[parent], data[i]);
+            i = parent;
+        }
+    }
+
+    constexpr void siftDown(size_t i) {
+        while (true) {
+            size_t largest = i, l = 2 * i + 1, r = l + 1;
+            if (l < curSize && cmp(data[largest], data[l])) largest = l;
+            if (r < curSize && cmp(data[largest], data[r])) largest = r;
+            if (largest == i) break;
+            swapElements(data[i], data[largest]);
+            i = largest;
+        }
+    }
+
+public:
+    constexpr static_priority_queue() : data{}, curSize(0), cmp() {}
+
+    constexpr explicit static_priority_queue(const Compare &c) : data{}, curSize(0), cmp(c) {}
+
+    /**
+     * @throws container_is_empty if empty() returns true
+     */
+    constexpr const T &top() const {
+        if (curSize == 0) {
+            throw container_is_empty();
+        }
+        return data[0];
+    }
+
+    /**
+     * @throws index_out_of_bound if the queue already holds Capacity elements
+     */
+    constexpr void push(const T &e) {
+        if (curSize == Capacity) {
+            throw index_out_of_bound();
+        }
+        data[curSize] = e;
+        siftUp(curSize++);
+    }
+
+    /**
+     * @throws container_is_empty if empty() returns true
+     */
+    constexpr void pop() {
+        if (curSize == 0) {
+            throw container_is_empty();
+        }
+        data[0] = data[--curSize];
+        siftDown(0);
+    }
+
+    constexpr size_t size() const {
+        return curSize;
+    }
+
+    constexpr bool empty() const {
+        return curSize == 0;
+    }
+
+    static constexpr size_t capacity() {
+        return Capacity;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,419 @@
+#ifndef SJTU_VEB_PRIORITY_QUEUE_HPP
+#define SJTU_VEB_PRIORITY_QUEUE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * A priority queue of unsigned integers of at most 32 bits, stored as a
+ * set of present keys instead of a heap, so push, top and pop take a
+ * constant number of word operations whatever the order of the keys
+ * (radix heaps need pops to be monotone; this does not).
+ *
+ * Following van Emde Boas, a key is split into a 16-bit page and a 16-bit
+ * offset. A summary set holds the non-empty pages and each page holds its
+ * offsets; both are 2^16-bit sets laid out as three levels of 64-way
+ * bitsets, so the largest or smallest member is three count-leading- or
+ * trailing-zero instructions away. Pages are allocated on first use, so
+ * memory follows the spread of the keys, but each page is 8456 bytes
+ * however few keys it holds. Uniform 32-bit keys put most of the 65536
+ * pages in use once n passes about 1e5, and the queue then holds about
+ * 0.52 GiB (0.55 GB) whatever n is, where the leftist priority_queue needs
+ * 32 bytes a node: this only pays for dense keys or for n in the millions.
+ * Repeated keys keep a count in a hash table, and only while they are
+ * repeated.
+ *
+ * Compare must be std::less<T> (top() is the largest key) or
+ * std::greater<T> (the smallest). It is never called, so nothing here
+ * throws runtime_error.
+ */
+template<typename T = uint32_t, class Compare = std::less<T>>
+class veb_priority_queue {
+    static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value && sizeof(T) <= 4,
+                  "keys are unsigned integers of at most 32 bits");
+    static_assert(std::is_same<Compare, std::less<T>>::value || std::is_same<Compare, std::greater<T>>::value,
+                  "Compare is std::less or std::greater");
+
+private:
+    static const bool largestFirst = std::is_same<Compare, std::less<T>>::value;
+
+    static unsigned highBit(uint64_t x) {
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(x);
+#else
+        unsigned i = 0;
+        while (x >>= 1) ++i;
+        return i;
+#endif
+    }
+
+    static unsigned lowBit(uint64_t x) {
+#if defined(__GNUC__)
+        return __builtin_ctzll(x);
+#else
+        unsigned i = 0;
+        while (!(x & 1)) x >>= 1, ++i;
+        return i;
+#endif
+    }
+
+    // 2^16 bits: bit i of leaf[w] is member 64 w + i, bit j of mid[m] says
+    // whether leaf[64 m + j] is non-zero, bit m of top whether mid[m] is.
+    // Bit w of repeats is set once a member of leaf[w] gets a second
+    // occurrence and cleared only when leaf[w] empties, so the repeat table
+    // need not be probed for the other words.
+    struct layer {
+        uint64_t leaf[1024];
+        uint64_t mid[16];
+        uint64_t top;
+        uint64_t repeats[16];
+
+        bool empty() const {
+            return top == 0;
+        }
+
+        bool test(unsigned i) const {
+            return leaf[i >> 6] >> (i & 63) & 1;
+        }
+
+        bool mayRepeat(unsigned i) const {
+            return repeats[i >> 12] >> (i >> 6 & 63) & 1;
+        }
+
+        void markRepeat(unsigned i) {
+            repeats[i >> 12] |= 1ull << (i >> 6 & 63);
+        }
+
+        void set(unsigned i) {
+            unsigned w = i >> 6, m = w >> 6;
+            if (!leaf[w]) {
+                mid[m] |= 1ull << (w & 63);
+                top |= 1ull << m;
+            }
+            leaf[w] |= 1ull << (i & 63);
+        }
+
+        void reset(unsigned i) {
+            unsigned w = i >> 6, m = w >> 6;
+            leaf[w] &= ~(1ull << (i & 63));
+            if (!leaf[w]) {
+                repeats[m] &= ~(1ull << (w & 63));
+                mid[m] &= ~(1ull << (w & 63));
+                if (!mid[m]) top &= ~(1ull << m);
+            }
+        }
+
+        unsigned max() const {
+            unsigned m = highBit(top);
+            unsigned w = m << 6 | highBit(mid[m]);
+            return w << 6 | highBit(leaf[w]);
+        }
+
+        unsigned min() const {
+            unsigned m = lowBit(top);
+            unsigned w = m << 6 | lowBit(mid[m]);
+            return w << 6 | lowBit(leaf[w]);
+        }
+
+        unsigned first() const {
+            return largestFirst ? max() : min();
+        }
+
+        // Rebuild mid and top after leaf was changed wholesale.
+        void resummarize() {
+            top = 0;
+            for (unsigned m = 0; m < 16; ++m) {
+                mid[m] = 0;
+                for (unsigned j = 0; j < 64; ++j) {
+                    if (leaf[m << 6 | j]) mid[m] |= 1ull << j;
+                }
+                if (mid[m]) top |= 1ull << m;
+            }
+        }
+    };
+
+    static const unsigned pageCount = 1u << 16;
+
+    layer *summary;  // non-empty pages; nullptr until the first push
+    layer **pages;
+    layer *spare;    // one emptied page kept to avoid churn at a page edge
+    std::unordered_map<T, size_t> extra;  // occurrences beyond the first
+    size_t curSize;
+    T topKey;        // the current top while not empty, so top() can return a reference
+
+    static bool before(T a, T b) {
+        return largestFirst ? a < b : a > b;
+    }
+
+    // Find the top again after the key that was on top left the set.
+    void refreshTop() {
+        if (summary->empty()) return;
+        unsigned p = summary->first();
+        topKey = (T)(p << 16 | pages[p]->first());
+    }
+
+    layer *newPage() {
+        if (spare) {
+            layer *page = spare;
+            spare = nullptr;
+            return page;
+        }
+        return new layer();
+    }
+
+    void releasePage(layer *page) {
+        if (spare) {
+            delete page;
+        } else {
+            spare = page;
+        }
+    }
+
+    // Allocate the summary and the page table, all empty.
+    void allocate() {
+        layer *newSummary = new layer();
+        try {
+            pages = new layer *[pageCount]();
+        } catch (...) {
+            delete newSummary;
+            throw;
+        }
+        summary = newSummary;
+    }
+
+    void release() {
+        if (pages) {
+            for (unsigned p = 0; p < pageCount; ++p) delete pages[p];
+        }
+        delete[] pages;
+        delete summary;
+        delete spare;
+        pages = nullptr;
+        summary = nullptr;
+        spare = nullptr;
+    }
+
+    void swap(veb_priority_queue &other) {
+        std::swap(summary, other.summary);
+        std::swap(pages, other.pages);
+        std::swap(spare, other.spare);
+        extra.swap(other.extra);
+        std::swap(curSize, other.curSize);
+        std::swap(topKey, other.topKey);
+    }
+
+    // Remove the one remaining occurrence of key x.
+    void removeKey(T x) {
+        unsigned p = (unsigned)x >> 16;
+        layer *page = pages[p];
+        page->reset(x & 0xffff);
+        if (page->empty()) {
+            summary->reset(p);
+            pages[p] = nullptr;
+            releasePage(page);
+        }
+        if (x == topKey) refreshTop();
+    }
+
+public:
+    /**
+     * @brief default constructor; allocates nothing until the first push.
+     */
+    veb_priority_queue() : summary(nullptr), pages(nullptr), spare(nullptr), extra(), curSize(0), topKey(0) {}
+
+    template<class InputIt>
+    veb_priority_queue(InputIt first, InputIt last) : veb_priority_queue() {
+        for (; first != last; ++first) push(*first);
+    }
+
+    veb_priority_queue(const veb_priority_queue &other)
+        : summary(nullptr), pages(nullptr), spare(nullptr), extra(other.extra), curSize(other.curSize),
+          topKey(other.topKey) {
+        if (!other.pages) return;
+
+        try {
+            allocate();
+            std::memcpy(summary, other.summary, sizeof(layer));
+            for (unsigned p = 0; p < pageCount; ++p) {
+                if (!other.pages[p]) continue;
+                pages[p] = new layer;
+                std::memcpy(pages[p], other.pages[p], sizeof(layer));
+            }
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    ~veb_priority_queue() {
+        release();
+    }
+
+    veb_priority_queue &operator=(const veb_priority_queue &other) {
+        if (this == &other) return *this;
+
+        veb_priority_queue copy(other);
+        swap(copy);
+        return *this;
+    }
+
+    /**
+     * @throws container_is_empty if empty() returns true
+     */
+    const T &top() const {
+        if (empty()) {
+            throw container_is_empty();
+        }
+        return topKey;
+    }
+
+    /**
+     * @brief add one occurrence of x; the queue is unchanged if allocation
+     * fails.
+     */
+    void push(const T &x) {
+        if (!pages) allocate();
+
+        unsigned p = (unsigned)x >> 16;
+        layer *page = pages[p];
+        if (page && page->test(x & 0xffff)) {
+            ++extra[x];
+            page->markRepeat(x & 0xffff);
+        } else {
+            if (!page) {
+                page = newPage();
+                pages[p] = page;
+                summary->set(p);
+            }
+            page->set(x & 0xffff);
+        }
+        if (empty() || before(topKey, x)) topKey = x;
+        ++curSize;
+    }
+
+    /**
+     * @throws container_is_empty if empty() returns true
+     */
+    void pop() {
+        if (empty()) {
+            throw container_is_empty();
+        }
+
+        T x = topKey;
+        erase(x);
+    }
+
+    /**
+     * @brief remove one occurrence of x, wherever it ranks.
+     * @return true if x was present.
+     */
+    bool erase(const T &x) {
+        if (!pages) return false;
+        const layer *page = pages[(unsigned)x >> 16];
+        if (!page || !page->test(x & 0xffff)) return false;
+
+        typename std::unordered_map<T, size_t>::iterator it =
+            page->mayRepeat(x & 0xffff) ? extra.find(x) : extra.end();
+        if (it == extra.end()) {
+            removeKey(x);
+        } else if (--it->second == 0) {
+            extra.erase(it);
+        }
+        --curSize;
+        return true;
+    }
+
+    /**
+     * @brief number of occurrences of x.
+     */
+    size_t count(const T &x) const {
+        if (!pages) return 0;
+
+        const layer *page = pages[(unsigned)x >> 16];
+        if (!page || !page->test(x & 0xffff)) return 0;
+        if (!page->mayRepeat(x & 0xffff)) return 1;
+        typename std::unordered_map<T, size_t>::const_iterator it = extra.find(x);
+        return it == extra.end() ? 1 : 1 + it->second;
+    }
+
+    size_t size() const {
+        return curSize;
+    }
+
+    bool empty() const {
+        return curSize == 0;
+    }
+
+    /**
+     * @brief move every element of other into this queue; other is cleared.
+     * Pages only other uses are taken over as they are; pages in use on both
+     * sides are OR-ed word by word. O(pages + keys present on both sides).
+     * If allocation fails, both queues are unchanged.
+     */
+    void merge(veb_priority_queue &other) {
+        if (this == &other || !other.pages) return;
+        if (!pages) {
+            swap(other);
+            return;
+        }
+
+        // Count the repeats first, undoing them if the table cannot grow,
+        // so that the pages only move once nothing can throw.
+        std::vector<std::pair<T, size_t>> repeats(other.extra.begin(), other.extra.end());
+        for (unsigned p = 0; p < pageCount; ++p) {
+            if (!pages[p] || !other.pages[p]) continue;
+            for (unsigned w = 0; w < 1024; ++w) {
+                for (uint64_t both = pages[p]->leaf[w] & other.pages[p]->leaf[w]; both; both &= both - 1) {
+                    repeats.push_back(std::make_pair((T)(p << 16 | w << 6 | lowBit(both)), 1));
+                }
+            }
+        }
+        size_t applied = 0;
+        try {
+            for (; applied < repeats.size(); ++applied) extra[repeats[applied].first] += repeats[applied].second;
+        } catch (...) {
+            while (applied-- > 0) {
+                typename std::unordered_map<T, size_t>::iterator it = extra.find(repeats[applied].first);
+                if ((it->second -= repeats[applied].second) == 0) extra.erase(it);
+            }
+            throw;
+        }
+
+        for (unsigned p = 0; p < pageCount; ++p) {
+            layer *theirs = other.pages[p];
+            if (!theirs) continue;
+            other.pages[p] = nullptr;
+            layer *mine = pages[p];
+            if (!mine) {
+                pages[p] = theirs;
+                summary->set(p);
+                continue;
+            }
+            for (unsigned w = 0; w < 1024; ++w) {
+                if (mine->leaf[w] & theirs->leaf[w]) mine->markRepeat(w << 6);
+                mine->leaf[w] |= theirs->leaf[w];
+            }
+            for (unsigned m = 0; m < 16; ++m) mine->repeats[m] |= theirs->repeats[m];
+            mine->resummarize();
+            delete theirs;
+        }
+        if (empty() || (!other.empty() && before(topKey, other.topKey))) topKey = other.topKey;
+        curSize += other.curSize;
+        other.curSize = 0;
+        other.extra.clear();
+        other.release();
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,221 @@
+#ifndef SJTU_WEAK_HEAP_HPP
+#define SJTU_WEAK_HEAP_HPP
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * An array-based weak heap, for comparators that cost far more than the
+ * data movement around them. A weak heap only orders every element before
+ * its right subtree, which is enough to
+ *  - build from n elements with exactly n - 1 comparisons,
+ *  - push with O(1) comparisons on average,
+ *  - pop with floor(log2 n) comparisons,
+ * so building and draining n elements takes about n log n - n comparisons,
+ * against about 1.5 n log n measured for the leftist priority_queue
+ * (see bench/compare_count.cpp).
+ *
+ * Layout: element i has children 2i + r[i] (left) and 2i + 1 - r[i] (right);
+ * the root 0 only has a right child, 1. Flipping r[i] swaps i's subtrees.
+ *
+ * Like priority_queue, top() is the largest element with respect to Compare,
+ * and an operation interrupted by a throwing Compare is rolled back.
+ * merge() is O(n + m), not O(log n).
+ */
+template<typename T, class Compare = std::less<T>>
+class weak_heap {
+private:
+    std::vector<T> a;
+    std::vector<unsigned char> r;  // reverse bits
+    Compare cmp;
+
+    // Every join that swapped is journaled so a throwing Compare can be
+    // undone; one push or pop performs at most one join per tree level.
+    static const size_t journalCapacity = 2 * sizeof(size_t) * 8;
+    struct journal {
+        size_t i[journalCapacity];
+        size_t j[journalCapacity];
+        size_t length = 0;
+    };
+
+    // The nearest ancestor of j whose right subtree contains j.
+    size_t dAncestor(size_t j) const {
+        while ((j & 1) == r[j >> 1]) j >>= 1;
+        return j >> 1;
+    }
+
+    // Restore order between i and its distinguished descendant j.
+    // @return true if they were already in order
+    bool join(size_t i, size_t j, journal &log) {
+        if (cmp(a[i], a[j])) {
+            std::swap(a[i], a[j]);
+            r[j] = !r[j];
+            log.i[log.length] = i;
+            log.j[log.length] = j;
+            ++log.length;
+            return false;
+        }
+        return true;
+    }
+
+    void rollback(journal &log) {
+        while (log.length > 0) {
+            --log.length;
+            size_t j = log.j[log.length];
+            std::swap(a[log.i[log.length]], a[j]);
+            r[j] = !r[j];
+        }
+    }
+
+    void build() {
+        journal log;
+        for (size_t j = a.size(); j-- > 1;) {
+            join(dAncestor(j), j, log);
+            log.length = 0;
+        }
+    }
+
+    void siftUp(size_t j, journal &log) {
+        while (j != 0) {
+            size_t i = dAncestor(j);
+            if (join(i, j, log)) break;
+            j = i;
+        }
+    }
+
+    void siftDown(journal &log) {
+        size_t n = a.size();
+        if (n <= 1) return;
+        size_t x = 1;
+        while (2 * x + r[x] < n) x = 2 * x + r[x];
+        for (; x != 0; x >>= 1) join(0, x, log);
+    }
+
+public:
+    /**
+     * @brief default constructor
+     */
+    weak_heap() : a(), r(), cmp() {}
+
+    explicit weak_heap(const Compare &c) : a(), r(), cmp(c) {}
+
+    /**
+     * @brief build from [first, last) with n - 1 comparisons.
+     * @throws runtime_error if Compare throws
+     */
+    template<class InputIt>
+    weak_heap(InputIt first, InputIt last, const Compare &c = Compare()) : a(first, last), r(a.size(), 0), cmp(c) {
+        try {
+            build();
+        } catch (...) {
+            throw runtime_error();
+        }
+    }
+
+    /**
+     * @throws container_is_empty if empty() returns true
+     */
+    const T &top() const {
+        if (empty()) {
+            throw container_is_empty();
+        }
+        return a[0];
+    }
+
+    /**
+     * @throws runtime_error if Compare throws; the heap is unchanged.
+     */
+    void push(const T &e) {
+        size_t n = a.size();
+        // Grow geometrically up front so the push_backs below cannot throw.
+        if (a.capacity() == n) a.reserve(2 * n + 1);
+        if (r.capacity() == n) r.reserve(2 * n + 1);
+        a.push_back(e);
+        r.push_back(0);
+        // A new leaf at an even index becomes the left child of n / 2.
+        unsigned char oldBit = 0;
+        if (n > 0 && (n & 1) == 0) {
+            oldBit = r[n / 2];
+            r[n / 2] = 0;
+        }
+        journal log;
+        try {
+            siftUp(n, log);
+        } catch (...) {
+            rollback(log);
+            if (n > 0 && (n & 1) == 0) r[n / 2] = oldBit;
+            a.pop_back();
+            r.pop_back();
+            throw runtime_error();
+        }
+    }
+
+    /**
+     * @throws container_is_empty if empty() returns true
+     * @throws runtime_error if Compare throws; the heap is unchanged.
+     */
+    void pop() {
+        if (empty()) {
+            throw container_is_empty();
+        }
+
+        size_t n = a.size();
+        T oldTop = std::move(a[0]);
+        if (n > 1) a[0] = std::move(a[n - 1]);
+        a.pop_back();
+        unsigned char oldBit = r[n - 1];
+        r.pop_back();
+        journal log;
+        try {
+            siftDown(log);
+        } catch (...) {
+            rollback(log);
+            // Only reachable for n > 1: a[0] holds the old last element again.
+            r.push_back(oldBit);
+            a.push_back(std::move(a[0]));
+            a[0] = std::move(oldTop);
+            throw runtime_error();
+        }
+    }
+
+    size_t size() const {
+        return a.size();
+    }
+
+    bool empty() const {
+        return a.empty();
+    }
+
+    /**
+     * @brief move every element of other into this heap and rebuild with
+     * n + m - 1 comparisons; other is cleared.
+     * @throws runtime_error if Compare throws; both heaps are unchanged.
+     */
+    void merge(weak_heap &other) {
+        if (this == &other) return;
+
+        weak_heap merged(cmp);
+        merged.a.reserve(a.size() + other.a.size());
+        merged.a.insert(merged.a.end(), a.begin(), a.end());
+        merged.a.insert(merged.a.end(), other.a.begin(), other.a.end());
+        merged.r.assign(merged.a.size(), 0);
+        try {
+            merged.build();
+        } catch (...) {
+            throw runtime_error();
+        }
+        a.swap(merged.a);
+        r.swap(merged.r);
+        other.a.clear();
+        other.r.clear();
+    }
+};
+
+}
+
+#endif
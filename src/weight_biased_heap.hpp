@@ -0,0 +1,305 @@
+#ifndef SJTU_WEIGHT_BIASED_HEAP_HPP
+#define SJTU_WEIGHT_BIASED_HEAP_HPP
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "exceptions.hpp"
+
+namespace sjtu {
+
+/**
+ * A weight-biased leftist heap: every node stores the size of its subtree,
+ * and the left child is never smaller than the right one. Because the
+ * merged size of a subtree is known before it is merged, every swap can be
+ * decided on the way down, so merge is a single top-down loop with no
+ * recursion and no second pass to fix ranks. The right spine of a heap of
+ * n elements has at most log2(n + 1) nodes, which bounds the loop.
+ *
+ * count_above(x) visits only the elements it counts, plus their children.
+ * It cannot use the stored sizes: a subtree whose root is above x may still
+ * hold any number of elements that are not.
+ *
+ * Like priority_queue, top() is the largest element with respect to Compare,
+ * merge() is O(log n), and an operation interrupted by a throwing Compare is
+ * rolled back.
+ */
+template<typename T, class Compare = std::less<T>>
+class weight_biased_heap {
+private:
+    struct Node {
+        T data;
+        Node *left;
+        Node *right;
+        size_t size;  // elements in this subtree
+
+        Node(const T &val) : data(val), left(nullptr), right(nullptr), size(1) {}
+    };
+
+    Node *root;
+    Compare cmp;
+
+    static size_t sizeOf(const Node *node) {
+        return node ? node->size : 0;
+    }
+
+    // Each merge step rewrites one node taken off one of the two right
+    // spines, so one merge journals at most two spines' worth of nodes.
+    static const size_t journalCapacity = 2 * sizeof(size_t) * 8;
+    struct journal {
+        Node *node[journalCapacity];
+        Node *left[journalCapacity];
+        Node *right[journalCapacity];
+        size_t size[journalCapacity];
+        size_t length = 0;
+    };
+
+    static void rollback(journal &log) {
+        while (log.length > 0) {
+            --log.length;
+            Node *node = log.node[log.length];
+            node->left = log.left[log.length];
+            node->right = log.right[log.length];
+            node->size = log.size[log.length];
+        }
+    }
+
+    // Walk down both right spines at once, linking the better root into the
+    // slot left by the previous step. The merged subtree below a node gets
+    // size(its right) + size(the other heap), so whether it belongs on the
+    // left or the right is known before it is built.
+    Node* mergeNodes(Node *a, Node *b) {
+        if (!a) return b;
+        if (!b) return a;
+
+        journal log;
+        Node *result = nullptr;
+        Node **slot = &result;
+        try {
+            while (a && b) {
+                if (cmp(a->data, b->data)) std::swap(a, b);
+
+                log.node[log.length] = a;
+                log.left[log.length] = a->left;
+                log.right[log.length] = a->right;
+                log.size[log.length] = a->size;
+                ++log.length;
+
+                Node *rest = a->right;
+                a->size += b->size;
+                *slot = a;
+                if (sizeOf(a->left) >= sizeOf(rest) + b->size) {
+                    slot = &a->right;
+                } else {
+                    a->right = a->left;
+                    slot = &a->left;
+                }
+                a = rest;
+            }
+        } catch (...) {
+            rollback(log);
+            throw;
+        }
+        *slot = a ? a : b;
+        return result;
+    }
+
+    // Copy subtree, walking left spines and stacking the right children.
+    static Node* copyTree(const Node *node) {
+        if (!node) return nullptr;
+
+        Node *newRoot = new Node(node->data);
+        newRoot->size = node->size;
+        try {
+            std::vector<std::pair<const Node *, Node *>> pending;
+            pending.push_back(std::make_pair(node, newRoot));
+            while (!pending.empty()) {
+                std::pair<const Node *, Node *> next = pending.back();
+                pending.pop_back();
+                for (const Node *from = next.first; from; from = from->left) {
+                    Node *to = next.second;
+                    if (from->right) {
+                        to->right = new Node(from->right->data);
+                        to->right->size = from->right->size;
+                        pending.push_back(std::make_pair(from->right, to->right));
+                    }
+                    if (from->left) {
+                        to->left = new Node(from->left->data);
+                        to->left->size = from->left->size;
+                        next.second = to->left;
+                    }
+                }
+            }
+        } catch (...) {
+            deleteTree(newRoot);
+            throw;
+        }
+        return newRoot;
+    }
+
+    // Delete subtree, rotating left children onto the right spine.
+    static void deleteTree(Node *node) {
+        while (node) {
+            if (node->left) {
+                Node *l = node->left;
+                node->left = l->right;
+                l->right = node;
+                node = l;
+            } else {
+                Node *r = node->right;
+                delete node;
+                node = r;
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief default constructor
+     */
+    weight_biased_heap() : root(nullptr), cmp() {}
+
+    explicit weight_biased_heap(const Compare &c) : root(nullptr), cmp(c) {}
+
+    /**
+     * @brief build from [first, last) in O(n) by melding equal-sized heaps
+     * like a binary counter.
+     * @throws runtime_error if Compare throws
+     */
+    template<class InputIt>
+    weight_biased_heap(InputIt first, InputIt last, const Compare &c = Compare()) : root(nullptr), cmp(c) {
+        Node *heaps[sizeof(size_t) * 8 + 1];
+        int top = 0;
+        try {
+            for (; first != last; ++first) {
+                heaps[top++] = new Node(*first);
+                while (top >= 2 && heaps[top - 1]->size == heaps[top - 2]->size) {
+                    heaps[top - 2] = mergeNodes(heaps[top - 2], heaps[top - 1]);
+                    --top;
+                }
+            }
+            while (top >= 2) {
+                heaps[top - 2] = mergeNodes(heaps[top - 2], heaps[top - 1]);
+                --top;
+            }
+        } catch (...) {
+            while (top > 0) deleteTree(heaps[--top]);
+            throw runtime_error();
+        }
+        root = top ? heaps[0] : nullptr;
+    }
+
+    /**
+     * @brief copy constructor
+     */
+    weight_biased_heap(const weight_biased_heap &other) : root(nullptr), cmp(other.cmp) {
+        root = copyTree(other.root);
+    }
+
+    ~weight_biased_heap() {
+        deleteTree(root);
+    }
+
+    weight_biased_heap &operator=(const weight_biased_heap &other) {
+        if (this == &other) return *this;
+
+        Node *newRoot = copyTree(other.root);
+        deleteTree(root);
+        root = newRoot;
+        cmp = other.cmp;
+        return *this;
+    }
+
+    /**
+     * @throws container_is_empty if empty() returns true
+     */
+    const T &top() const {
+        if (empty()) {
+            throw container_is_empty();
+        }
+        return root->data;
+    }
+
+    /**
+     * @throws runtime_error if Compare throws; the heap is unchanged.
+     */
+    void push(const T &e) {
+        Node *newNode = new Node(e);
+        try {
+            root = mergeNodes(root, newNode);
+        } catch (...) {
+            delete newNode;
+            throw runtime_error();
+        }
+    }
+
+    /**
+     * @throws container_is_empty if empty() returns true
+     * @throws runtime_error if Compare throws; the heap is unchanged.
+     */
+    void pop() {
+        if (empty()) {
+            throw container_is_empty();
+        }
+
+        Node *oldRoot = root;
+        try {
+            root = mergeNodes(oldRoot->left, oldRoot->right);
+        } catch (...) {
+            throw runtime_error();
+        }
+        delete oldRoot;
+    }
+
+    size_t size() const {
+        return sizeOf(root);
+    }
+
+    bool empty() const {
+        return root == nullptr;
+    }
+
+    /**
+     * @brief meld other into this heap in O(log n); other is cleared.
+     * @throws runtime_error if Compare throws; both heaps are unchanged.
+     */
+    void merge(weight_biased_heap &other) {
+        if (this == &other) return;
+
+        try {
+            root = mergeNodes(root, other.root);
+        } catch (...) {
+            throw runtime_error();
+        }
+        other.root = nullptr;
+    }
+
+    /**
+     * @brief number of elements e with Compare(x, e), i.e. strictly above
+     * x. A subtree whose root is not above x holds nothing above x, so the
+     * cost is O(k + 1) for an answer of k; size() - count_above(x) counts
+     * the rest. Exceptions thrown by Compare propagate unchanged.
+     */
+    size_t count_above(const T &x) const {
+        if (!root || !cmp(x, root->data)) return 0;
+
+        size_t count = 0;
+        std::vector<const Node *> pending(1, root);
+        while (!pending.empty()) {
+            const Node *node = pending.back();
+            pending.pop_back();
+            // node is above x; follow its left spine while that stays so.
+            for (; node; node = node->left) {
+                ++count;
+                if (node->right && cmp(x, node->right->data)) pending.push_back(node->right);
+                if (node->left && !cmp(x, node->left->data)) break;
+            }
+        }
+        return count;
+    }
+};
+
+}
+
+#endif